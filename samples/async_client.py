@@ -0,0 +1,137 @@
+#
+#   mg_python asyncio Test Page
+#
+#      Copyright (c) 2008-2023 MGateway Ltd.
+#      All rights reserved.
+#
+#   This test page writes to global ^MyGlobal
+#
+#   The requests are encoded and the responses decoded by mg_python (m_request,
+#   m_response_size and m_response) while the network I/O is done by asyncio,
+#   so many requests can be in flight at once without tying up a thread each.
+#   Requests sent over a connection are answered in order, so each connection
+#   writes its requests immediately and a single reader task resolves them in turn.
+#
+
+import asyncio
+import collections
+import mg_python
+
+
+class MConnection:
+
+   def __init__(self, reader, writer):
+      self.reader = reader
+      self.writer = writer
+      self.waiting = collections.deque()
+      self.task = asyncio.ensure_future(self.receive())
+
+   async def receive(self):
+      try:
+         while True:
+            head = await self.reader.readexactly(8)
+            size = mg_python.m_response_size(head)
+            body = await self.reader.readexactly(size - 8)
+            future = self.waiting.popleft()
+            if future.cancelled():
+               continue
+            try:
+               future.set_result(mg_python.m_response(head + body))
+            except Exception as error:
+               future.set_exception(error)
+      except Exception as error:
+         while self.waiting:
+            future = self.waiting.popleft()
+            if not future.done():
+               future.set_exception(ConnectionError(str(error)))
+
+   def request(self, request):
+      future = asyncio.get_running_loop().create_future()
+      self.waiting.append(future)
+      self.writer.write(request)
+      return future
+
+   async def close(self):
+      self.writer.close()
+      self.task.cancel()
+
+
+class MClient:
+
+   def __init__(self, db, host, port, connections=4):
+      self.db = db
+      self.host = host
+      self.port = port
+      self.size = connections
+      self.connections = []
+      self.next = 0
+
+   async def open(self):
+      for n in range(0, self.size):
+         reader, writer = await asyncio.open_connection(self.host, self.port)
+         self.connections.append(MConnection(reader, writer))
+      return self
+
+   async def close(self):
+      for connection in self.connections:
+         await connection.close()
+      self.connections = []
+
+   def request(self, op, name, *args):
+      connection = self.connections[self.next]
+      self.next = (self.next + 1) % len(self.connections)
+      return connection.request(mg_python.m_request(self.db, op, name, *args))
+
+   def set(self, name, *args):
+      return self.request("set", name, *args)
+
+   def get(self, name, *args):
+      return self.request("get", name, *args)
+
+   def kill(self, name, *args):
+      return self.request("kill", name, *args)
+
+   def data(self, name, *args):
+      return self.request("data", name, *args)
+
+   def order(self, name, *args):
+      return self.request("order", name, *args)
+
+   def previous(self, name, *args):
+      return self.request("previous", name, *args)
+
+   def increment(self, name, *args):
+      return self.request("increment", name, *args)
+
+   def function(self, name, *args):
+      return self.request("function", name, *args)
+
+
+async def main():
+   db = 0
+
+   mg_python.m_set_host(db, "localhost", 7041, "", "")
+   mg_python.m_set_uci(db, "USER")
+
+   client = await MClient(db, "localhost", 7041).open()
+
+   print('\nSet up some records in ^MyGlobal ...')
+   await asyncio.gather(*[client.set("^MyGlobal", key, "Record #" + str(key)) for key in range(0, 10)])
+
+   print('\nRead them back concurrently ...')
+   values = await asyncio.gather(*[client.get("^MyGlobal", key) for key in range(0, 10)])
+   for key in range(0, 10):
+      print(key, " = ", values[key])
+
+   print('\nParse records in order ($Order) ...')
+   key1 = await client.order("^MyGlobal", "")
+   while (key1 != ""):
+      print(key1, " = ", await client.get("^MyGlobal", key1))
+      key1 = await client.order("^MyGlobal", key1)
+
+   # print('\nInvoke M function: $$add^math(2,3): ' + await client.function("add^math", 2, 3))
+
+   await client.close()
+
+
+asyncio.run(main())
@@ -0,0 +1,102 @@
+#
+#   mg_python Reference Count and Memory Regression Test Page
+#
+#      Copyright (c) 2008-2023 MGateway Ltd.
+#      All rights reserved.
+#
+#   This test page writes to global ^MyLeakCheck
+#
+#   Each call is repeated many times and the test fails if the reference
+#   counts of the objects passed in change, or if the memory held by the
+#   Python allocator (tracemalloc) or by the process (RSS) keeps growing.
+#   Int and float keys and values are included because their text used to be
+#   held in temporary Python objects that were never released.
+#
+#      python leak_check.py [<host> [<port>]] [-n <repeat>]
+#
+
+import gc
+import sys
+import tracemalloc
+import mg_python
+
+
+def rss_kb():
+   try:
+      with open("/proc/self/statm") as statm:
+         return int(statm.read().split()[1]) * 4
+   except OSError:
+      import resource
+      return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+
+
+def check(name, function, watch):
+   # Warm up first so that one-off allocations (connections, buffers) are not counted
+   for n in range(100):
+      function()
+   gc.collect()
+   refs = [sys.getrefcount(item) for item in watch]
+   traced = tracemalloc.get_traced_memory()[0]
+   rss = rss_kb()
+
+   for n in range(repeat):
+      function()
+
+   gc.collect()
+   refs_growth = [sys.getrefcount(item) for item in watch]
+   refs_growth = [count - refs[n] for n, count in enumerate(refs_growth)]
+   traced_growth = tracemalloc.get_traced_memory()[0] - traced
+   rss_growth = rss_kb() - rss
+
+   ok = not any(refs_growth) and traced_growth < 64 * 1024 and rss_growth < 1024
+   print("%-26s refcounts %-14s tracemalloc %+8d bytes   RSS %+6d KB   %s" % (name, refs_growth, traced_growth, rss_growth, "ok" if ok else "FAILED"))
+   return ok
+
+
+db = 0
+host = "localhost"
+port = 7041
+repeat = 20000
+
+argv = sys.argv[1:]
+if "-n" in argv:
+   n = argv.index("-n")
+   repeat = int(argv[n + 1])
+   del argv[n:n + 2]
+if len(argv) > 0:
+   host = argv[0]
+if len(argv) > 1:
+   port = int(argv[1])
+
+mg_python.m_set_host(db, host, port, "", "")
+mg_python.m_set_uci(db, "USER")
+
+print("\nmg_python version: ", mg_python.m_ext_version())
+print("\nRepeating each call %d times ...\n" % repeat)
+
+key_int = 123456
+key_big = 123456789012
+key_float = 2.5
+value_int = 987654321
+mg_python.m_kill(db, "^MyLeakCheck")
+
+key = [1, key_int]
+records = []
+
+tracemalloc.start()
+results = [
+   check("m_set (int keys)", lambda: mg_python.m_set(db, "^MyLeakCheck", key_int, key_big, value_int), [key_int, key_big, value_int]),
+   check("m_set (float key)", lambda: mg_python.m_set(db, "^MyLeakCheck", key_float, key_int), [key_float, key_int]),
+   check("m_get (int keys)", lambda: mg_python.m_get(db, "^MyLeakCheck", key_int, key_big), [key_int, key_big]),
+   check("ma_merge_from_db", lambda: mg_python.ma_merge_from_db(db, "^MyLeakCheck", key, records, ""), [key, key_int, records]),
+   check("ma_local_sort", lambda: mg_python.ma_local_sort(db, records), [records]),
+]
+tracemalloc.stop()
+
+mg_python.m_kill(db, "^MyLeakCheck")
+
+if all(results):
+   print("\nAll tests passed")
+else:
+   print("\nSome tests FAILED")
+   sys.exit(1)
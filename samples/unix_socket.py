@@ -0,0 +1,164 @@
+#
+#   mg_python UNIX Domain Socket Test Page
+#
+#      Copyright (c) 2008-2023 MGateway Ltd.
+#      All rights reserved.
+#
+#   This test page connects to a DB Server through a UNIX domain socket
+#   (a netname of unix:<path> passed to m_set_host) and checks that records
+#   written with m_set can be read back with m_get, m_data and m_order.
+#
+#   By default a minimal stand-in for the DB Superserver is started on a
+#   temporary socket so that the client side can be tested without a database.
+#   The stand-in understands just enough of the protocol for this page (Set,
+#   Get, Kill, Data and Order against an in-memory global).  To run the page
+#   against a real DB Superserver, give the path to its socket instead:
+#
+#      python unix_socket.py /tmp/zmgsi.sock
+#
+
+import os
+import socket
+import sys
+import tempfile
+import threading
+import mg_python
+
+
+B62 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+
+
+class StandInServer:
+
+   def __init__(self, path):
+      self.path = path
+      self.data = {}
+      self.lock = threading.Lock()
+      self.listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+      self.listener.bind(path)
+      self.listener.listen(8)
+      threading.Thread(target=self.accept, daemon=True).start()
+
+   def close(self):
+      self.listener.close()
+      os.unlink(self.path)
+
+   def accept(self):
+      while True:
+         try:
+            client, address = self.listener.accept()
+         except OSError:
+            return
+         threading.Thread(target=self.serve, args=(client,), daemon=True).start()
+
+   def serve(self, client):
+      stream = client.makefile("rb")
+      try:
+         while True:
+            head = stream.readline()
+            if not head:
+               return
+            if head.startswith(b"^A^"):
+               # Connection handshake
+               client.sendall(b"00000cv\n")
+               continue
+            # Request header: ...^<command>^<size (5 base-62 digits)>\n
+            size = 0
+            for c in head[-6:-1].decode():
+               size = (size * 62) + B62.index(c)
+            command = head.split(b"^")[-2].decode()
+            result = self.execute(command, self.items(stream.read(size)))
+            client.sendall(self.encode_size(len(result)) + b"cv\n" + result)
+      finally:
+         stream.close()
+         client.close()
+
+   def items(self, body):
+      # Each item is a code byte (length of the size field in the low three bits), the size and the data
+      items = []
+      n = 0
+      while n < len(body):
+         width = body[n] % 8
+         size = int(body[n + 1:n + 1 + width] or b"0")
+         n += 1 + width
+         items.append(body[n:n + size])
+         n += size
+      return items
+
+   def encode_size(self, size):
+      digits = ""
+      for n in range(5):
+         digits = B62[size % 62] + digits
+         size //= 62
+      return digits.encode()
+
+   def execute(self, command, items):
+      with self.lock:
+         if command == "S":
+            self.data[tuple(items[:-1])] = items[-1]
+            return b""
+         key = tuple(items)
+         if command == "G":
+            return self.data.get(key, b"")
+         if command == "K":
+            for node in [node for node in self.data if node[:len(key)] == key]:
+               del self.data[node]
+            return b""
+         if command == "D":
+            data = 1 if key in self.data else 0
+            if any(len(node) > len(key) and node[:len(key)] == key for node in self.data):
+               data += 10
+            return str(data).encode()
+         if command == "O":
+            # String collation only: this page uses keys of equal length
+            prefix = key[:-1]
+            subscripts = sorted({node[len(prefix)] for node in self.data if len(node) > len(prefix) and node[:len(prefix)] == prefix})
+            subscripts = [s for s in subscripts if key[-1] == b"" or s > key[-1]]
+            return subscripts[0] if subscripts else b""
+         return b""
+
+
+db = 0
+server = None
+
+if len(sys.argv) > 1:
+   path = sys.argv[1]
+else:
+   path = os.path.join(tempfile.mkdtemp(), "zmgsi.sock")
+   server = StandInServer(path)
+
+print("\nAccess to M database via the UNIX domain socket " + path)
+
+mg_python.m_set_host(db, "unix:" + path, 0, "", "")
+mg_python.m_set_uci(db, "USER")
+
+print("\nmg_python version: ", mg_python.m_ext_version())
+
+print('\nSet up some records in ^MyGlobal ...')
+mg_python.m_kill(db, "^MyGlobal")
+for key in range(0, 10):
+   mg_python.m_set(db, "^MyGlobal", key, "Record #" + str(key))
+
+print('\nRead the records back ...')
+for key in range(0, 10):
+   value = mg_python.m_get(db, "^MyGlobal", key)
+   assert value == "Record #" + str(key), value
+assert mg_python.m_data(db, "^MyGlobal") == "10"
+assert mg_python.m_data(db, "^MyGlobal", 3) == "1"
+
+print('\nParse records in order ($Order) ...')
+count = 0
+key1 = mg_python.m_order(db, "^MyGlobal", "")
+while (key1 != ""):
+   print(key1, " = ", mg_python.m_get(db, "^MyGlobal", key1))
+   count = count + 1
+   key1 = mg_python.m_order(db, "^MyGlobal", key1)
+assert count == 10, count
+
+mg_python.m_kill(db, "^MyGlobal")
+assert mg_python.m_data(db, "^MyGlobal") == "0"
+
+if server is not None:
+   server.close()
+
+print("\nAll tests passed")
@@ -91,6 +91,51 @@ Version 1.3.16 15 June 2022:
 Version 1.3.17 12 January 2023:
    Remove the need to prefix global names with the '^' character for API-based connections to YottaDB.
 
+Version 1.3.18 17 October 2026:
+   Make the network connection table safe for use by concurrent threads.
+   - Slots are claimed and released under the global lock and are only reused by the server that created them.
+   Direct SimpleAPI access to YottaDB globals for the embedded (mg_python) API mode: mg_invoke_server_api_global().
+   Direct call-in access to InterSystems globals for the same mode: isc_global_ex().
+   - Canonical numeric subscripts are pushed as native integers (or doubles) rather than strings.
+   Reusable request/response buffers held by the server structure: mg_buf_get() and mg_buf_release().
+   - Each server guards its buffers with its own lock (buf_cache_lock) rather than with dbx_global_mutex; mg_init_critical_section() and mg_delete_critical_section() now also set up and release POSIX mutexes.
+   - mg_buf_resize() grows buffers geometrically and preserves their content.
+   - Fix the growth of the response buffer in mg_db_receive() for responses larger than the initial buffer.
+   - Fix memory leaks in mg_db_connect_init() and mg_db_ayt().
+   mg_buf_cat() and mg_buf_cpy() grow buffers geometrically.
+   Allow large requests to be sent to the DB Server in chunks as they are built: mg_request_add_size() and mg_request_stream().
+   Add mg_time() for timing requests.
+   Add a $Query ('Q') command to the direct YottaDB global interface: ydb_query_ex().
+   Add next/previous subscript with data ('N'/'R') commands to the direct global interfaces: mg_global_next_data().
+   Support several requests sent together on one connection: mg_request_size() and mg_db_receive_next().
+   - mg_db_receive() waits for the whole response header before deciding that a response is empty.
+   - mg_db_receive_next() acknowledges each response immediately (where TCP_QUICKACK is available).
+   Replace the shared network connection table with a connection pool held by each server (MGSRV).
+   - Configurable minimum and maximum size (up to MG_MAXCON, now 1024), a timed wait for a free connection and idle eviction.
+   - mg_pool_init(), mg_pool_close(), mg_pool_wait(), mg_pool_signal(), mg_pool_evict() and mg_db_close().
+   Open connections for a pool in parallel before they are needed: mg_pool_warm().
+   - mg_db_connect() is split into mg_pool_reserve() and mg_pool_open().
+   - The pool functions only write the server's error message (p_srv->error_mess) while holding dbx_global_mutex.
+   Check the idle connections in a pool from a background thread and replace those that fail: mg_health_start(), mg_health_stop() and mg_health_check().
+   - mg_db_ayt() takes a timeout and no longer treats its message as a framed request (mg_db_send() mode 0).
+   - Condition variables used with dbx_global_mutex: mg_cond_init(), mg_cond_wait(), mg_cond_signal() and mg_cond_destroy().
+   - Once a pool is closed, connections released into it are closed rather than pooled, and mg_pool_destroy() releases its condition variables.
+   - mg_db_connect() and mg_pool_warm() no longer open connections for a pool that has been closed.
+   - A connection on which a transaction is open is held for the thread that started it until the transaction ends: mg_pool_transaction() and mg_pool_pinned().
+   Wait for sockets using poll() rather than select() (other than on Windows): netx_tcp_poll().
+   - Sockets numbered FD_SETSIZE or above no longer overflow the fd_set in mg_db_receive(), netx_tcp_read() and netx_tcp_connect_ex().
+   - Correct the connection timeout in netx_tcp_connect_ex() (the microseconds were set to the number of seconds).
+   Optionally spin on a non-blocking receive before blocking in mg_db_receive(): netx_tcp_spin() and netx_tcp_spin_tune().
+   Connect to a DB Server through a UNIX domain socket (ip_address of unix:<path>): netx_unix_connect().
+   - The ip_address held by the server (MGSRV) is enlarged to 128 bytes to accommodate the path.
+   Send large request elements from the caller's memory instead of copying them into the request buffer: mg_db_send_iov().
+   - Enabled for a request by attaching an MGIOV to its buffer (p_buf->p_iov); elements of MG_IOV_MIN bytes or more are then referenced by mg_request_add().
+   - The request is sent with writev() (a segment at a time on Windows).
+   Allow the caller to supply the memory for the data of a large response: mg_db_receive() mode 2 and mg_db_receive_rest().
+   - In mode 2, mg_db_receive() stops once it knows that the response will not fit the buffer, rather than enlarging the buffer.
+   Push canonical integer subscripts of 10 to 18 digits as 64-bit integers (DBX_DTYPE_INT64) in isc_push_subscript().
+   - The amount for $Increment (isc_global_ex()) is pushed the same way instead of being converted to a double; an empty amount is an error.
+
 */
 
 
@@ -3591,6 +3636,187 @@ int isc_pop_value(DBXCON *pcon, DBXVAL *value, int required_type)
 }
 
 
+/* v1.3.18 */
+int isc_push_subscript(DBXCON *pcon, DBXVAL *arg)
+{
+   int rc, n, len, dot, digits;
+   double real;
+   char *p;
+   char buffer[32];
+
+   p = (char *) arg->svalue.buf_addr;
+   len = (int) arg->svalue.len_used;
+   arg->type = DBX_DTYPE_STR;
+
+   /* Subscripts in canonical numeric form are pushed as native numbers */
+   dot = 0;
+   digits = 0;
+   for (n = (len > 1 && p[0] == '-') ? 1 : 0; n < len; n ++) {
+      if (p[n] == '.' && !dot) {
+         dot = n + 1;
+      }
+      else if (p[n] >= '0' && p[n] <= '9') {
+         digits ++;
+      }
+      else {
+         digits = 0;
+         break;
+      }
+   }
+   if (digits > 0 && len < 20 && !(p[0] == '-' && len == 2 && p[1] == '0')) {
+      n = (p[0] == '-') ? 1 : 0;
+      if (!dot && digits < 10 && (p[n] != '0' || len == 1)) {
+         arg->type = DBX_DTYPE_INT;
+         arg->num.int32 = (int) strtol(p, NULL, 10);
+         return pcon->p_isc_so->p_CachePushInt(arg->num.int32);
+      }
+      if (!dot && digits < 19 && p[n] != '0' && pcon->p_isc_so->p_CachePushInt64) {
+         /* v1.3.18: integers of up to 18 digits (the width of a 64-bit integer) */
+         arg->type = DBX_DTYPE_INT64;
+         strncpy(buffer, p, len);
+         buffer[len] = '\0';
+         arg->num.int64 = (long long) strtoll(buffer, NULL, 10);
+         return pcon->p_isc_so->p_CachePushInt64((CACHE_INT64) arg->num.int64);
+      }
+      if (dot && len < 16 && p[len - 1] != '0' && p[len - 1] != '.' && p[n] != '0') {
+         /* Only fractions held exactly by a double collate as the equivalent canonical number */
+         strncpy(buffer, p, len);
+         buffer[len] = '\0';
+         real = (double) strtod(buffer, NULL);
+         if ((real * 65536) == floor(real * 65536)) {
+            arg->type = DBX_DTYPE_DOUBLE;
+            arg->num.real = real;
+            return pcon->p_isc_so->p_CachePushDbl(arg->num.real);
+         }
+      }
+   }
+
+   if (len < DBX_MAXSIZE) {
+      rc = pcon->p_isc_so->p_CachePushStr(len, (Callin_char_t *) p);
+   }
+   else {
+      arg->cvalue.pstr = (void *) pcon->p_isc_so->p_CacheExStrNew((CACHE_EXSTRP) &(arg->cvalue.zstr), len);
+      if (arg->cvalue.pstr == NULL) {
+         return CACHE_FAILURE;
+      }
+      memcpy((void *) arg->cvalue.zstr.str.ch, (void *) p, (size_t) len);
+      arg->cvalue.zstr.len = len;
+      rc = pcon->p_isc_so->p_CachePushExStr((CACHE_EXSTRP) &(arg->cvalue.zstr));
+   }
+
+   return rc;
+}
+
+
+/* v1.3.18 */
+int isc_global_ex(DBXMETH *pmeth)
+{
+   int rc, n, data, argc;
+   CACHE_EXSTR zstr;
+   DBXCON *pcon = pmeth->pcon;
+
+   if (pmeth->command[0] == 'N' || pmeth->command[0] == 'R') {
+      return mg_global_next_data(pmeth, isc_global_ex);
+   }
+
+   pmeth->output_val.svalue.len_used = 0;
+
+   if (pmeth->args[0].svalue.buf_addr[0] == '^')
+      rc = pcon->p_isc_so->p_CachePushGlobal((int) pmeth->args[0].svalue.len_used - 1, (Callin_char_t *) pmeth->args[0].svalue.buf_addr + 1);
+   else
+      rc = pcon->p_isc_so->p_CachePushGlobal((int) pmeth->args[0].svalue.len_used, (Callin_char_t *) pmeth->args[0].svalue.buf_addr);
+
+   /* The last argument to Set and Increment is the value rather than a subscript */
+   argc = pmeth->argc;
+   if (pmeth->command[0] == 'S' || pmeth->command[0] == 'I') {
+      argc --;
+   }
+   for (n = 1; rc == CACHE_SUCCESS && n < argc; n ++) {
+      rc = isc_push_subscript(pcon, &(pmeth->args[n]));
+   }
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+
+   switch (pmeth->command[0]) {
+      case 'S':
+         n = pmeth->argc - 1;
+         if (pmeth->args[n].svalue.len_used < DBX_MAXSIZE) {
+            rc = pcon->p_isc_so->p_CachePushStr((int) pmeth->args[n].svalue.len_used, (Callin_char_t *) pmeth->args[n].svalue.buf_addr);
+         }
+         else {
+            pmeth->args[n].cvalue.pstr = (void *) pcon->p_isc_so->p_CacheExStrNew((CACHE_EXSTRP) &(pmeth->args[n].cvalue.zstr), pmeth->args[n].svalue.len_used);
+            if (pmeth->args[n].cvalue.pstr == NULL) {
+               return CACHE_FAILURE;
+            }
+            memcpy((void *) pmeth->args[n].cvalue.zstr.str.ch, (void *) pmeth->args[n].svalue.buf_addr, (size_t) pmeth->args[n].svalue.len_used);
+            pmeth->args[n].cvalue.zstr.len = pmeth->args[n].svalue.len_used;
+            rc = pcon->p_isc_so->p_CachePushExStr((CACHE_EXSTRP) &(pmeth->args[n].cvalue.zstr));
+         }
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_isc_so->p_CacheGlobalSet(pmeth->argc - 2);
+         }
+         return rc;
+      case 'G':
+         rc = pcon->p_isc_so->p_CacheGlobalGet(pmeth->argc - 1, 0);
+         if (rc == CACHE_ERUNDEF) {
+            return CACHE_SUCCESS;
+         }
+         break;
+      case 'K':
+         return pcon->p_isc_so->p_CacheGlobalKill(pmeth->argc - 1, 0);
+      case 'D':
+         data = 0;
+         rc = pcon->p_isc_so->p_CacheGlobalData(pmeth->argc - 1, 0);
+         if (rc == CACHE_SUCCESS) {
+            pcon->p_isc_so->p_CachePopInt(&data);
+            sprintf(pmeth->output_val.svalue.buf_addr, "%d", data);
+            pmeth->output_val.svalue.len_used = (unsigned int) strlen(pmeth->output_val.svalue.buf_addr);
+         }
+         return rc;
+      case 'O':
+      case 'P':
+         rc = pcon->p_isc_so->p_CacheGlobalOrder(pmeth->argc - 1, pmeth->command[0] == 'O' ? 1 : -1, 0);
+         break;
+      case 'I':
+         n = pmeth->argc - 1;
+         if (pmeth->args[n].svalue.len_used == 0) {
+            strcpy(pcon->error, "No increment value was supplied");
+            return CACHE_FAILURE;
+         }
+         /* The increment goes through as it was given: integers and exact fractions as native numbers, anything else as a string */
+         rc = isc_push_subscript(pcon, &(pmeth->args[n]));
+         if (rc == CACHE_SUCCESS) {
+            rc = pcon->p_isc_so->p_CacheGlobalIncrement(pmeth->argc - 2);
+         }
+         break;
+      default:
+         return CACHE_FAILURE;
+   }
+
+   if (rc != CACHE_SUCCESS) {
+      return rc;
+   }
+
+   /* Get, Order and Increment leave their result on the stack */
+   zstr.len = 0;
+   zstr.str.ch = NULL;
+   rc = pcon->p_isc_so->p_CachePopExStr(&zstr);
+   if (rc == CACHE_SUCCESS) {
+      pmeth->output_val.svalue.len_used = zstr.len;
+      if (zstr.len > pmeth->output_val.svalue.len_alloc) {
+         rc = CACHE_STRTOOLONG;
+      }
+      else if (zstr.len > 0) {
+         memcpy((void *) pmeth->output_val.svalue.buf_addr, (void *) zstr.str.ch, (size_t) zstr.len);
+      }
+      pcon->p_isc_so->p_CacheExStrKill(&zstr);
+   }
+
+   return rc;
+}
+
+
 int isc_error_message(DBXMETH *pmeth, int error_code)
 {
    int size, size1, len;
@@ -4229,6 +4455,125 @@ int ydb_function_ex(DBXMETH *pmeth, DBXFUN *pfun)
 }
 
 
+/* v1.3.18: global commands issued directly through the SimpleAPI rather than via ifc^%zmgsis */
+int ydb_global_ex(DBXMETH *pmeth)
+{
+   int rc;
+   unsigned int data;
+   DBXCON *pcon = pmeth->pcon;
+
+   pmeth->output_val.svalue.len_used = 0;
+
+   switch (pmeth->command[0]) {
+      case 'S':
+         rc = pcon->p_ydb_so->p_ydb_set_s(&(pmeth->args[0].svalue), pmeth->argc - 2, &pmeth->yargs[0], &(pmeth->args[pmeth->argc - 1].svalue));
+         break;
+      case 'G':
+         rc = pcon->p_ydb_so->p_ydb_get_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], &(pmeth->output_val.svalue));
+         if (rc == YDB_ERR_GVUNDEF || rc == YDB_ERR_LVUNDEF) {
+            pmeth->output_val.svalue.len_used = 0;
+            rc = YDB_OK;
+         }
+         break;
+      case 'K':
+         rc = pcon->p_ydb_so->p_ydb_delete_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], YDB_DEL_TREE);
+         break;
+      case 'D':
+         data = 0;
+         rc = pcon->p_ydb_so->p_ydb_data_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], &data);
+         if (rc == YDB_OK) {
+            sprintf(pmeth->output_val.svalue.buf_addr, "%u", data);
+            pmeth->output_val.svalue.len_used = (unsigned int) strlen(pmeth->output_val.svalue.buf_addr);
+         }
+         break;
+      case 'O':
+      case 'P':
+         if (pmeth->command[0] == 'O')
+            rc = pcon->p_ydb_so->p_ydb_subscript_next_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], &(pmeth->output_val.svalue));
+         else
+            rc = pcon->p_ydb_so->p_ydb_subscript_previous_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], &(pmeth->output_val.svalue));
+         /* as for YDB_TPCTX_ORDER: any other status (normally YDB_ERR_NODEEND) marks the end of the list */
+         if (rc != YDB_OK && rc != YDB_ERR_INVSTRLEN) {
+            pmeth->output_val.svalue.len_used = 0;
+            rc = YDB_OK;
+         }
+         break;
+      case 'I':
+         rc = pcon->p_ydb_so->p_ydb_incr_s(&(pmeth->args[0].svalue), pmeth->argc - 2, &pmeth->yargs[0], &(pmeth->args[pmeth->argc - 1].svalue), &(pmeth->output_val.svalue));
+         break;
+      case 'Q':
+         rc = ydb_query_ex(pmeth);
+         break;
+      case 'N':
+      case 'R':
+         rc = mg_global_next_data(pmeth, ydb_global_ex);
+         break;
+      default:
+         rc = YDB_FAILURE;
+         break;
+   }
+
+   pmeth->output_val.num.int32 = rc;
+
+   return rc;
+}
+
+
+/* v1.3.18: $Query - the subscripts of the next node are returned in output_val, each preceded by its length (4 bytes) */
+int ydb_query_ex(DBXMETH *pmeth)
+{
+   int rc, n, nkeys, chunk;
+   unsigned int len, offset;
+   ydb_buffer_t keys[YDB_MAX_SUBS];
+   DBXCON *pcon = pmeth->pcon;
+
+   /* Each subscript is returned into its own slot of the output buffer and then packed down */
+   chunk = (int) (pmeth->output_val.svalue.len_alloc / YDB_MAX_SUBS);
+   if (chunk < 8) {
+      pmeth->output_val.svalue.len_used = YDB_MAX_SUBS * 260;
+      return YDB_ERR_INVSTRLEN;
+   }
+   for (n = 0; n < YDB_MAX_SUBS; n ++) {
+      keys[n].buf_addr = pmeth->output_val.svalue.buf_addr + (n * chunk) + 4;
+      keys[n].len_alloc = chunk - 4;
+      keys[n].len_used = 0;
+   }
+
+   nkeys = YDB_MAX_SUBS;
+   rc = pcon->p_ydb_so->p_ydb_node_next_s(&(pmeth->args[0].svalue), pmeth->argc - 1, &pmeth->yargs[0], &nkeys, &keys[0]);
+   if (rc == YDB_ERR_NODEEND || nkeys == YDB_NODE_END) {
+      pmeth->output_val.svalue.len_used = 0;
+      return YDB_OK;
+   }
+   if (rc == YDB_ERR_INVSTRLEN) {
+      len = 0;
+      for (n = 0; n < YDB_MAX_SUBS; n ++) {
+         if (keys[n].len_used > len) {
+            len = keys[n].len_used;
+         }
+      }
+      pmeth->output_val.svalue.len_used = (len + 8) * YDB_MAX_SUBS;
+      return rc;
+   }
+   if (rc != YDB_OK) {
+      return rc;
+   }
+
+   offset = 0;
+   for (n = 0; n < nkeys; n ++) {
+      len = keys[n].len_used;
+      mg_set_size((unsigned char *) pmeth->output_val.svalue.buf_addr + offset, (unsigned long) len);
+      if (len > 0) {
+         memmove((void *) (pmeth->output_val.svalue.buf_addr + offset + 4), (void *) keys[n].buf_addr, (size_t) len);
+      }
+      offset += (len + 4);
+   }
+   pmeth->output_val.svalue.len_used = offset;
+
+   return YDB_OK;
+}
+
+
 /* v1.2.9 */
 int ydb_transaction_cb(void *pargs)
 {
@@ -5296,6 +5641,7 @@ int mg_buf_init(MGBUF *p_buf, int size, int increment_size)
    p_buf->size = size;
    p_buf->increment_size = increment_size;
    p_buf->data_size = 0;
+   p_buf->p_iov = NULL;
 
    return result;
 }
@@ -5303,13 +5649,30 @@ int mg_buf_init(MGBUF *p_buf, int size, int increment_size)
 
 int mg_buf_resize(MGBUF *p_buf, unsigned long size)
 {
+   unsigned char *p_temp;
+
    if (size < MG_BUFSIZE)
       return 1;
 
    if (size < p_buf->size)
       return 1;
 
-   p_buf->p_buffer = (unsigned char *) mg_realloc((void *) p_buf->p_buffer, 0, sizeof(char) * size, 0);
+   /* v1.3.18: grow geometrically and preserve the current content */
+   if (size < (p_buf->size * 2)) {
+      size = p_buf->size * 2;
+   }
+   p_temp = (unsigned char *) mg_malloc(sizeof(char) * (size + 1), 0);
+   if (!p_temp) {
+      return 0;
+   }
+   if (p_buf->p_buffer) {
+      if (p_buf->data_size > 0) {
+         memcpy((void *) p_temp, (void *) p_buf->p_buffer, p_buf->data_size);
+      }
+      mg_free((void *) p_buf->p_buffer, 0);
+   }
+   p_temp[p_buf->data_size] = '\0';
+   p_buf->p_buffer = p_temp;
    p_buf->size = size;
 
    return 1;
@@ -5337,6 +5700,7 @@ int mg_buf_free(MGBUF *p_buf)
 int mg_buf_cpy(LPMGBUF p_buf, char *buffer, unsigned long size)
 {
    unsigned long  result, req_size, csize, increment_size;
+   MGIOV *p_iov;
 
    result = 1;
 
@@ -5351,12 +5715,15 @@ int mg_buf_cpy(LPMGBUF p_buf, char *buffer, unsigned long size)
 
    req_size = size;
    if (req_size > p_buf->size) {
-      csize = p_buf->size;
+      /* v1.3.18: grow geometrically */
+      csize = p_buf->size * 2;
       increment_size = p_buf->increment_size;
-      while (req_size > csize)
-         csize = csize + p_buf->increment_size;
+      if (req_size > csize)
+         csize = req_size;
+      p_iov = p_buf->p_iov;
       mg_buf_free(p_buf);
-      result = mg_buf_init(p_buf, (int) size, (int) increment_size);
+      result = mg_buf_init(p_buf, (int) csize, (int) increment_size);
+      p_buf->p_iov = p_iov;
    }
    if (result) {
       memcpy((void *) p_buf->p_buffer, (void *) buffer, size);
@@ -5372,6 +5739,7 @@ int mg_buf_cat(LPMGBUF p_buf, char *buffer, unsigned long size)
 {
    unsigned long int result, req_size, csize, tsize, increment_size;
    unsigned char *p_temp;
+   MGIOV *p_iov;
 
    result = 1;
 
@@ -5385,12 +5753,17 @@ int mg_buf_cat(LPMGBUF p_buf, char *buffer, unsigned long size)
    req_size = (size + p_buf->data_size);
    tsize = p_buf->data_size;
    if (req_size > p_buf->size) {
-      csize = p_buf->size;
+      /* v1.3.18: grow geometrically rather than by increment_size to avoid quadratic copying for large requests */
+      csize = p_buf->size * 2;
       increment_size = p_buf->increment_size;
+      if (csize < increment_size)
+         csize = increment_size;
       while (req_size > csize)
-         csize = csize + p_buf->increment_size;
+         csize = csize * 2;
       p_temp = p_buf->p_buffer;
+      p_iov = p_buf->p_iov;
       result = mg_buf_init(p_buf, (int) csize, (int) increment_size);
+      p_buf->p_iov = p_iov;
       if (result) {
          if (p_temp) {
             memcpy((void *) p_buf->p_buffer, (void *) p_temp, tsize);
@@ -5411,6 +5784,103 @@ int mg_buf_cat(LPMGBUF p_buf, char *buffer, unsigned long size)
 }
 
 
+/* v1.3.18 */
+int mg_buf_get(MGSRV *p_srv, MGBUF *p_buf)
+{
+   p_buf->p_buffer = NULL;
+
+   if (p_srv) {
+      mg_enter_critical_section((void *) &(p_srv->buf_cache_lock));
+      if (p_srv->buf_cache_count > 0) {
+         p_srv->buf_cache_count --;
+         *p_buf = p_srv->buf_cache[p_srv->buf_cache_count];
+      }
+      mg_leave_critical_section((void *) &(p_srv->buf_cache_lock));
+   }
+
+   if (p_buf->p_buffer) {
+      p_buf->data_size = 0;
+      p_buf->p_buffer[0] = '\0';
+      p_buf->p_iov = NULL;
+      return 1;
+   }
+
+   return mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+}
+
+
+/* v1.3.18 */
+int mg_buf_release(MGSRV *p_srv, MGBUF *p_buf)
+{
+   int result;
+   unsigned char *p_temp;
+
+   if (!p_buf->p_buffer) {
+      return 0;
+   }
+   if (!p_srv || p_srv->buf_cache_max < 1) {
+      return mg_buf_free(p_buf);
+   }
+
+   /* Buffers that have grown beyond the high-water mark are shrunk back before being reused */
+   if (p_buf->size > (unsigned long) p_srv->buf_high_water) {
+      p_temp = (unsigned char *) mg_malloc(sizeof(char) * (MG_BUFSIZE + 1), 0);
+      if (!p_temp) {
+         return mg_buf_free(p_buf);
+      }
+      mg_free((void *) p_buf->p_buffer, 0);
+      p_buf->p_buffer = p_temp;
+      p_buf->size = MG_BUFSIZE;
+      p_buf->increment_size = MG_BUFSIZE;
+   }
+   p_buf->data_size = 0;
+   p_buf->p_iov = NULL;
+
+   result = 0;
+   mg_enter_critical_section((void *) &(p_srv->buf_cache_lock));
+   if (p_srv->buf_cache_count < p_srv->buf_cache_max && p_srv->buf_cache_count < MG_BUF_CACHE) {
+      p_srv->buf_cache[p_srv->buf_cache_count] = *p_buf;
+      p_srv->buf_cache_count ++;
+      result = 1;
+   }
+   mg_leave_critical_section((void *) &(p_srv->buf_cache_lock));
+
+   if (result) {
+      p_buf->p_buffer = NULL;
+      p_buf->size = 0;
+      p_buf->data_size = 0;
+      return 1;
+   }
+
+   return mg_buf_free(p_buf);
+}
+
+
+/* v1.3.18 */
+int mg_buf_cache_free(MGSRV *p_srv, int max)
+{
+   int n;
+   MGBUF buf;
+
+   for (;;) {
+      n = 0;
+      mg_enter_critical_section((void *) &(p_srv->buf_cache_lock));
+      if (p_srv->buf_cache_count > max) {
+         p_srv->buf_cache_count --;
+         buf = p_srv->buf_cache[p_srv->buf_cache_count];
+         n = 1;
+      }
+      mg_leave_critical_section((void *) &(p_srv->buf_cache_lock));
+      if (!n) {
+         break;
+      }
+      mg_buf_free(&buf);
+   }
+
+   return 1;
+}
+
+
 void * mg_realloc(void *p, int curr_size, int new_size, short id)
 {
    if (dbx_ext_realloc) {
@@ -6003,6 +6473,8 @@ int mg_init_critical_section(void *p_crit)
 {
 #if defined(_WIN32)
    InitializeCriticalSection((LPCRITICAL_SECTION) p_crit);
+#else
+   pthread_mutex_init((pthread_mutex_t *) p_crit, NULL); /* v1.3.18 */
 #endif
 
    return 0;
@@ -6013,6 +6485,8 @@ int mg_delete_critical_section(void *p_crit)
 {
 #if defined(_WIN32)
    DeleteCriticalSection((LPCRITICAL_SECTION) p_crit);
+#else
+   pthread_mutex_destroy((pthread_mutex_t *) p_crit); /* v1.3.18 */
 #endif
 
    return 0;
@@ -6085,6 +6559,20 @@ int mg_sleep(unsigned long msecs)
    return 0;
 }
 
+
+/* v1.3.18 */
+double mg_time(void)
+{
+#if defined(_WIN32)
+   return ((double) GetTickCount()) / 1000;
+#else
+   struct timeval tp;
+
+   gettimeofday(&tp, NULL);
+   return ((double) tp.tv_sec) + (((double) tp.tv_usec) / 1000000);
+#endif
+}
+
 int netx_load_winsock(DBXCON *pcon, int context)
 {
 #if defined(_WIN32)
@@ -6332,7 +6820,7 @@ int netx_tcp_connect(DBXCON *pcon, int context)
    int n, errorno;
    unsigned long inetaddr;
    DWORD spin_count;
-   char ansi_ip_address[64];
+   char ansi_ip_address[128];
    struct sockaddr_in srv_addr, cli_addr;
    struct hostent *hp;
    struct in_addr **pptr;
@@ -6343,6 +6831,11 @@ int netx_tcp_connect(DBXCON *pcon, int context)
    getaddrinfo_ok = 0;
    spin_count = 0;
 
+   /* v1.3.18: unix:<path> addresses a UNIX domain socket */
+   if (!strncmp((char *) pcon->ip_address, "unix:", 5)) {
+      return netx_unix_connect(pcon, (char *) pcon->ip_address + 5);
+   }
+
    ipv6 = 1;
 #if !defined(NETX_IPV6)
    ipv6 = 0;
@@ -6833,6 +7326,52 @@ int netx_tcp_command(DBXMETH *pmeth, int context)
 }
 
 
+/* v1.3.18: connect to a DB Server listening on a UNIX domain socket (same host) */
+int netx_unix_connect(DBXCON *pcon, char *path)
+{
+#if defined(_WIN32)
+   strcpy(pcon->error, "Connection Error: UNIX domain sockets are not supported on this platform");
+   return -5;
+#else
+   int n, errorno;
+   char message[256];
+   struct sockaddr_un srv_addr;
+
+   if (!path[0] || strlen(path) >= sizeof(srv_addr.sun_path)) {
+      strcpy(pcon->error, "Connection Error: Invalid path for UNIX domain socket");
+      return -2;
+   }
+
+   pcon->cli_socket = NETX_SOCKET(AF_UNIX, SOCK_STREAM, 0);
+
+   if (INVALID_SOCK(pcon->cli_socket)) {
+      errorno = (int) netx_get_last_error(0);
+      netx_get_error_message(errorno, message, 250, 0);
+      sprintf(pcon->error, "Connection Error: Invalid Socket: Context=4: Error Code: %d (%s)", errorno, message);
+      return -2;
+   }
+
+   memset((void *) &srv_addr, 0, sizeof(srv_addr));
+   srv_addr.sun_family = AF_UNIX;
+   strcpy(srv_addr.sun_path, path);
+
+   n = NETX_CONNECT(pcon->cli_socket, (xLPSOCKADDR) &srv_addr, (socklen_netx) sizeof(srv_addr));
+
+   if (SOCK_ERROR(n)) {
+      errorno = (int) netx_get_last_error(0);
+      netx_get_error_message(errorno, message, 250, 0);
+      sprintf(pcon->error, "Connection Error: Cannot Connect to Server (%s): Error Code: %d (%s)", (char *) pcon->ip_address, errorno, message);
+      netx_tcp_disconnect(pcon, 0);
+      return -5;
+   }
+
+   pcon->connected = 1;
+
+   return 0;
+#endif
+}
+
+
 int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_addr_len, int timeout)
 {
 #if defined(_WIN32)
@@ -6840,8 +7379,6 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 #else
    int flags, n, error;
    socklen_netx len;
-   fd_set rset, wset;
-   struct timeval tval;
 #endif
 
 #if defined(SOLARIS) && BIT64PLAT
@@ -6889,14 +7426,7 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 
       if (n != 0) {
 
-         FD_ZERO(&rset);
-         FD_SET(pcon->cli_socket, &rset);
-
-         wset = rset;
-         tval.tv_sec = timeout;
-         tval.tv_usec = timeout;
-
-         n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, &wset, NULL, &tval);
+         n = netx_tcp_poll(pcon, 1, timeout * 1000); /* v1.3.18 */
 
          if (n == 0) {
             close(pcon->cli_socket);
@@ -6904,7 +7434,7 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
 
             return (-2);
          }
-         if (NETX_FD_ISSET(pcon->cli_socket, &rset) || NETX_FD_ISSET(pcon->cli_socket, &wset)) {
+         if (n > 0) {
 
             len = sizeof(error);
             if (NETX_GETSOCKOPT(pcon->cli_socket, SOL_SOCKET, SO_ERROR, (void *) &error, &len) < 0) {
@@ -6915,7 +7445,7 @@ int netx_tcp_connect_ex(DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_a
             }
          }
          else {
-            ;
+            error = errno;
          }
       }
 
@@ -7020,43 +7550,139 @@ int netx_tcp_write(DBXCON *pcon, unsigned char *data, int size)
 
 
 
-int netx_tcp_read(DBXCON *pcon, unsigned char *data, int size, int timeout, int context)
+/* v1.3.18: wait up to timeout msecs for the socket to become readable (or writable); returns > 0 when ready, 0 on timeout and < 0 on error */
+/*          poll() is used where available because select() cannot handle descriptors numbered FD_SETSIZE or above */
+int netx_tcp_poll(DBXCON *pcon, int write, int timeout)
 {
-   int result, n;
-   int len;
+   int n;
+#if defined(_WIN32)
    fd_set rset, eset;
    struct timeval tval;
-   unsigned long spin_count;
 
+   FD_ZERO(&rset);
+   FD_ZERO(&eset);
+   FD_SET(pcon->cli_socket, &rset);
+   FD_SET(pcon->cli_socket, &eset);
 
-   if (!pcon) {
-      return NETX_READ_ERROR;
+   tval.tv_sec = timeout / 1000;
+   tval.tv_usec = (timeout % 1000) * 1000;
+
+   if (write) {
+      n = NETX_SELECT((int) (pcon->cli_socket + 1), NULL, &rset, &eset, &tval);
+   }
+   else {
+      n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, NULL, &eset, &tval);
    }
+   if (n > 0 && !NETX_FD_ISSET(pcon->cli_socket, &rset)) {
+      n = -1;
+   }
+#else
+   struct pollfd pfd;
 
-   result = 0;
+   pfd.fd = pcon->cli_socket;
+   pfd.events = write ? POLLOUT : POLLIN;
+   pfd.revents = 0;
 
-   tval.tv_sec = timeout;
-   tval.tv_usec = 0;
+   do {
+      n = poll(&pfd, 1, timeout);
+   } while (n < 0 && errno == EINTR);
 
-   spin_count = 0;
-   len = 0;
-   for (;;) {
-      spin_count ++;
+   /* A pending connection that fails is reported through SO_ERROR, so any event will do when writing */
+   if (n > 0 && !write && !(pfd.revents & POLLIN)) {
+      n = -1;
+   }
+#endif
 
-      FD_ZERO(&rset);
-      FD_ZERO(&eset);
-      FD_SET(pcon->cli_socket, &rset);
-      FD_SET(pcon->cli_socket, &eset);
+   return n;
+}
 
-      n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, NULL, &eset, &tval);
 
-      if (n == 0) {
+/* v1.3.18: busy-poll the socket with non-blocking reads for up to usecs; returns the number of bytes read, */
+/*          0 if the connection has been closed, -1 on error or -2 if there was nothing to read in the time allowed */
+int netx_tcp_spin(DBXCON *pcon, unsigned char *data, int size, int usecs)
+{
+#if defined(MSG_DONTWAIT)
+   int n;
+   double end;
+
+   end = mg_time() + ((double) usecs / 1000000);
+   for (;;) {
+      n = (int) NETX_RECV(pcon->cli_socket, (char *) data, size, MSG_DONTWAIT);
+      if (n >= 0) {
+         return n;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+         return -1;
+      }
+      if (mg_time() >= end) {
+         break;
+      }
+   }
+#endif
+
+   return -2;
+}
+
+
+/* v1.3.18: adjust the time spent spinning on a connection: twice the last response time if it arrived while spinning, */
+/*          otherwise half the previous time (usecs < 0); the time is kept between MG_SPIN_MIN and spin_max */
+/*          A change to spin_max starts again from spin_max */
+int netx_tcp_spin_tune(DBXCON *pcon, int spin_max, int usecs)
+{
+   if (pcon->spin_max != spin_max) {
+      pcon->spin_max = spin_max;
+      pcon->spin = spin_max;
+#if defined(SO_BUSY_POLL)
+      /* Let the kernel busy-poll the device queue too (where permitted) */
+      NETX_SETSOCKOPT(pcon->cli_socket, SOL_SOCKET, SO_BUSY_POLL, (const char *) &spin_max, sizeof(int));
+#endif
+      return pcon->spin;
+   }
+
+   if (usecs < 0) {
+      pcon->spin /= 2;
+   }
+   else {
+      pcon->spin = usecs * 2;
+   }
+   if (pcon->spin < MG_SPIN_MIN) {
+      pcon->spin = MG_SPIN_MIN;
+   }
+   if (pcon->spin > spin_max) {
+      pcon->spin = spin_max;
+   }
+
+   return pcon->spin;
+}
+
+
+int netx_tcp_read(DBXCON *pcon, unsigned char *data, int size, int timeout, int context)
+{
+   int result, n;
+   int len;
+   unsigned long spin_count;
+
+
+   if (!pcon) {
+      return NETX_READ_ERROR;
+   }
+
+   result = 0;
+
+   spin_count = 0;
+   len = 0;
+   for (;;) {
+      spin_count ++;
+
+      n = netx_tcp_poll(pcon, 0, timeout * 1000); /* v1.3.18 */
+
+      if (n == 0) {
          sprintf(pcon->error, "TCP Read Error: Server did not respond within the timeout period (%d seconds)", timeout);
          result = NETX_READ_TIMEOUT;
          break;
       }
 
-      if (n < 0 || !NETX_FD_ISSET(pcon->cli_socket, &rset)) {
+      if (n < 0) {
           strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned any data");
           result = NETX_READ_ERROR;
          break;
@@ -7626,62 +8252,366 @@ int mg_db_command(DBXMETH *pmeth, int context)
 }
 
 
-int mg_db_connect(MGSRV *p_srv, int *p_chndle, short context)
+/* v1.3.18 */
+int mg_cond_init(DBXCOND *p_cond)
+{
+#if defined(_WIN32)
+   InitializeConditionVariable(p_cond);
+#else
+   pthread_cond_init(p_cond, NULL);
+#endif
+
+   return 1;
+}
+
+
+/* v1.3.18: wait (holding dbx_global_mutex) for the condition to be signalled; returns zero on timeout */
+int mg_cond_wait(DBXCOND *p_cond, int msecs)
+{
+#if defined(_WIN32)
+
+   return SleepConditionVariableCS(p_cond, &dbx_global_mutex, (DWORD) msecs) ? 1 : 0;
+
+#else
+   struct timeval tp;
+   struct timespec ts;
+
+   gettimeofday(&tp, NULL);
+   ts.tv_sec = tp.tv_sec + (msecs / 1000);
+   ts.tv_nsec = (tp.tv_usec * 1000) + ((long) (msecs % 1000) * 1000000);
+   if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec ++;
+      ts.tv_nsec -= 1000000000;
+   }
+
+   return pthread_cond_timedwait(p_cond, &dbx_global_mutex, &ts) ? 0 : 1;
+
+#endif
+}
+
+
+/* v1.3.18 */
+int mg_cond_signal(DBXCOND *p_cond)
+{
+#if defined(_WIN32)
+   WakeConditionVariable(p_cond);
+#else
+   pthread_cond_signal(p_cond);
+#endif
+
+   return 1;
+}
+
+
+/* v1.3.18: no thread may be waiting on the condition (Windows condition variables need no cleanup) */
+int mg_cond_destroy(DBXCOND *p_cond)
 {
-   int rc, n, free;
+#if !defined(_WIN32)
+   pthread_cond_destroy(p_cond);
+#endif
+
+   return 1;
+}
+
+
+/* v1.3.18: each server (MGSRV) holds its own pool of network connections */
+int mg_pool_init(MGSRV *p_srv)
+{
+   p_srv->pool_min = 0;
+   p_srv->pool_max = MG_POOL_MAX;
+   p_srv->pool_wait = MG_POOL_WAIT;
+   p_srv->pool_idle = 0;
+   p_srv->pool_size = 0;
+   p_srv->pool_free = 0;
+   p_srv->pool_waiting = 0;
+   p_srv->pool_closed = 0;
+   p_srv->pool_pinned = 0;
+   mg_cond_init(&(p_srv->pool_cond));
+
+   p_srv->health_interval = 0;
+   p_srv->health_timeout = MG_HEALTH_TIMEOUT;
+   p_srv->health_running = 0;
+   mg_cond_init(&(p_srv->health_cond));
+
+   p_srv->spin_max = 0;
+
+   return 1;
+}
+
+
+/* v1.3.18: close the idle connections in the pool (those in use are closed as they are released) */
+int mg_pool_close(MGSRV *p_srv)
+{
+   int n;
    DBXCON *pcon;
-   DBXMETH *pmeth;
+
+   for (;;) {
+      pcon = NULL;
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+      p_srv->pool_closed = 1;
+      if (p_srv->pool_free > 0) {
+         p_srv->pool_free --;
+         n = p_srv->pool_stack[p_srv->pool_free];
+         pcon = p_srv->pcon[n];
+         p_srv->pcon[n] = NULL;
+         p_srv->pool_size --;
+      }
+      else if (p_srv->pool_pinned > 0) {
+         /* Idle connections held for a transaction are not on the stack (the transaction is rolled back) */
+         for (n = 0; n < MG_MAXCON; n ++) {
+            if (p_srv->pcon[n] && p_srv->pcon[n]->pinned && !p_srv->pcon[n]->in_use) {
+               pcon = p_srv->pcon[n];
+               pcon->pinned = 0;
+               p_srv->pool_pinned --;
+               p_srv->pcon[n] = NULL;
+               p_srv->pool_size --;
+               break;
+            }
+         }
+      }
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      if (!pcon) {
+         break;
+      }
+      mg_db_close(pcon);
+   }
+
+   return 1;
+}
+
+
+/* v1.3.18: release the resources of a pool that has been closed, once no thread can be using it */
+int mg_pool_destroy(MGSRV *p_srv)
+{
+   mg_cond_destroy(&(p_srv->pool_cond));
+   mg_cond_destroy(&(p_srv->health_cond));
+
+   return 1;
+}
+
+
+/* v1.3.18: wait (holding dbx_global_mutex) for a connection to be released; returns zero on timeout */
+int mg_pool_wait(MGSRV *p_srv, int msecs)
+{
+   int result;
+
+   p_srv->pool_waiting ++;
+   result = mg_cond_wait(&(p_srv->pool_cond), msecs);
+   p_srv->pool_waiting --;
+
+   return result;
+}
+
+
+/* v1.3.18: wake a thread waiting for a connection (called holding dbx_global_mutex) */
+int mg_pool_signal(MGSRV *p_srv)
+{
+   return mg_cond_signal(&(p_srv->pool_cond));
+}
+
+
+/* v1.3.18: detach the least recently used idle connection if it has been idle for longer than allowed (called holding dbx_global_mutex) */
+DBXCON * mg_pool_evict(MGSRV *p_srv, double now)
+{
+   int n;
+   DBXCON *pcon;
+
+   if (p_srv->pool_idle < 1 || p_srv->pool_free < 1 || p_srv->pool_size <= p_srv->pool_min) {
+      return NULL;
+   }
+
+   pcon = p_srv->pcon[p_srv->pool_stack[0]];
+   if ((now - pcon->idle_since) < (double) p_srv->pool_idle) {
+      return NULL;
+   }
+
+   for (n = 1; n < p_srv->pool_free; n ++) {
+      p_srv->pool_stack[n - 1] = p_srv->pool_stack[n];
+   }
+   p_srv->pool_free --;
+   p_srv->pcon[pcon->chndle] = NULL;
+   p_srv->pool_size --;
+
+   return pcon;
+}
+
+
+/* v1.3.18: find the idle connection held for a transaction started by thread tid (called holding dbx_global_mutex) */
+DBXCON * mg_pool_pinned(MGSRV *p_srv, DBXTHID tid)
+{
+   int n;
+   DBXCON *pcon;
+
+   for (n = 0; n < MG_MAXCON; n ++) {
+      pcon = p_srv->pcon[n];
+      if (pcon && pcon->pinned && !pcon->in_use && pcon->tthread == tid) {
+         return pcon;
+      }
+   }
+
+   return NULL;
+}
+
+
+/* v1.3.18: follow the transaction level of a network connection from the response to a transaction command */
+/*          ('a' tstart, 'b' $tlevel, 'c' tcommit or 'd' trollback); returns the level */
+int mg_pool_transaction(MGSRV *p_srv, int chndle, char *command, MGBUF *p_buf)
+{
+   DBXCON *pcon;
+
+   if (p_srv->mode == 2 || chndle < 0 || chndle >= MG_MAXCON || !p_srv->pcon[chndle]) {
+      return 0;
+   }
+   pcon = p_srv->pcon[chndle];
+   if (p_buf->data_size < MG_RECV_HEAD || mg_get_error(p_srv, (char *) p_buf->p_buffer)) {
+      return pcon->tlevel;
+   }
+
+   switch (command[0]) {
+      case 'a':
+         pcon->tlevel ++;
+         break;
+      case 'b':
+         pcon->tlevel = (int) strtol((char *) p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+         break;
+      case 'c':
+         if (pcon->tlevel > 0) {
+            pcon->tlevel --;
+         }
+         break;
+      case 'd':
+         pcon->tlevel = 0;
+         break;
+      default:
+         break;
+   }
+
+   return pcon->tlevel;
+}
+
+
+int mg_db_connect(MGSRV *p_srv, int *p_chndle, short context)
+{
+   int n;
+   double now, expiry;
+   DBXCON *pcon, *p_idle;
 
    if (p_srv->mode == 2) {
       return 1;
    }
 
-   free = -1;
    *p_chndle = -1;
-   for (n = 0; n < MG_MAXCON; n ++) {
-      if (connection[n]) {
-         if (!connection[n]->in_use) {
-            *p_chndle = n;
-            connection[*p_chndle]->in_use = 1;
-            connection[*p_chndle]->eod = 0;
+   pcon = NULL;
+   now = mg_time();
+   expiry = now + ((double) p_srv->pool_wait / 1000);
+
+   /* v1.3.18: reuse the most recently released connection, open a new one if the pool has room, or else wait for one to be released */
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+
+   /* v1.3.18: no new connections are opened for a pool that has been closed */
+   if (p_srv->pool_closed) {
+      strcpy(p_srv->error_mess, "No connection available: connection pool closed");
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return 0;
+   }
+
+   /* v1.3.18: a thread with a transaction open keeps to the connection on which it was started */
+   if (p_srv->pool_pinned > 0 && (pcon = mg_pool_pinned(p_srv, mg_current_thread_id()))) {
+      *p_chndle = pcon->chndle;
+      pcon->in_use = 1;
+      pcon->eod = 0;
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return 1;
+   }
+
+   for (;;) {
+      if (p_srv->pool_free > 0) {
+         p_srv->pool_free --;
+         *p_chndle = p_srv->pool_stack[p_srv->pool_free];
+         pcon = p_srv->pcon[*p_chndle];
+         pcon->in_use = 1;
+         pcon->eod = 0;
+         break;
+      }
+      if (p_srv->pool_size < p_srv->pool_max) {
+         for (n = 0; n < MG_MAXCON; n ++) {
+            if (!p_srv->pcon[n]) {
+               *p_chndle = n;
+               break;
+            }
+         }
+         if (*p_chndle != -1) {
             break;
          }
       }
-      else {
-         if (free == -1) {
-            free = n;
+      n = (int) ((expiry - now) * 1000);
+      if (n < 1 || !mg_pool_wait(p_srv, n)) {
+         if (p_srv->pool_free < 1 && p_srv->pool_size >= p_srv->pool_max) {
+            strcpy(p_srv->error_mess, "No connection available: connection pool exhausted");
+            mg_leave_critical_section((void *) &dbx_global_mutex);
+            return 0;
          }
       }
+      now = mg_time();
    }
 
-   if (*p_chndle != -1) {
-      p_srv->pcon[*p_chndle] = connection[*p_chndle];
+   if (pcon) {
+      p_idle = mg_pool_evict(p_srv, now);
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      if (p_idle) {
+         mg_db_close(p_idle);
+      }
       return 1;
    }
 
-   if (free == -1) {
+   pcon = mg_pool_reserve(p_srv, *p_chndle);
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   if (pcon == NULL) {
       return 0;
    }
 
-   *p_chndle = free;
+   return mg_pool_open(p_srv, pcon);
+}
+
+
+/* v1.3.18: allocate a connection for the free slot chndle (called holding dbx_global_mutex) */
+DBXCON * mg_pool_reserve(MGSRV *p_srv, int chndle)
+{
+   DBXCON *pcon;
+   DBXMETH *pmeth;
 
    pcon = (PDBXCON) mg_malloc(sizeof(DBXCON), 0);
    if (pcon == NULL) {
-      return 0;
+      return NULL;
    }
    memset((void *) pcon, 0, sizeof(DBXCON));
    pmeth = (PDBXMETH) mg_malloc(sizeof(DBXMETH), 0);
    if (pmeth == NULL) {
       mg_free((void *) pcon, 0);
-      return 0;
+      return NULL;
    }
    memset((void *) pmeth, 0, sizeof(DBXMETH));
    pcon->pmeth_base = (void *) pmeth;
    pmeth->pcon = pcon;
+   pcon->in_use = 1;
+   pcon->p_srv = p_srv;
 
-   connection[*p_chndle] = pcon;
-   pcon->chndle = *p_chndle;
-   p_srv->pcon[*p_chndle] = connection[*p_chndle];
+   pcon->chndle = chndle;
+   p_srv->pcon[chndle] = pcon;
+   p_srv->pool_size ++;
+
+   return pcon;
+}
+
+
+/* v1.3.18: connect a connection reserved by mg_pool_reserve() to the DB Server, giving back its slot on failure */
+int mg_pool_open(MGSRV *p_srv, DBXCON *pcon)
+{
+   int rc;
+   DBXMETH *pmeth;
+
+   pmeth = (DBXMETH *) pcon->pmeth_base;
 
    pcon->use_db_mutex = 0; /* v1.3.12 */
    pcon->tlevel = 0;
@@ -7703,45 +8633,405 @@ int mg_db_connect(MGSRV *p_srv, int *p_chndle, short context)
    pcon->port = p_srv->port;
 
    pcon->eod = 0;
-   strcpy(p_srv->error_mess, "");
 
    rc = netx_tcp_connect(pcon, 0);
 
    if (rc != CACHE_SUCCESS) {
       pcon->connected = 0;
       rc = CACHE_NOCON;
+
+      /* v1.3.18: give the slot back rather than leaving it permanently in use */
+      /* The error is reported (in p_srv->error_mess) under the lock since connections to the same server may be opened in parallel */
+      mg_enter_critical_section((void *) &dbx_global_mutex);
       mg_error_message(pmeth, rc);
+      p_srv->pcon[pcon->chndle] = NULL;
+      p_srv->pool_size --;
+      if (p_srv->pool_waiting) {
+         mg_pool_signal(p_srv);
+      }
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      mg_free((void *) pmeth, 0);
+      mg_free((void *) pcon, 0);
+      return 0;
+   }
+
+   return 1;
+
+}
+
+
+/* v1.3.18: open connections for the pool in parallel (one thread each) before they are needed */
+int mg_pool_warm(MGSRV *p_srv, int count, char *global)
+{
+   int n, max, result;
+   MGWARM *p_warm;
+
+   if (p_srv->mode == 2) {
+      return 0;
+   }
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   if (p_srv->pool_closed) {
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return 0;
+   }
+   if (count > p_srv->pool_max) {
+      count = p_srv->pool_max;
+   }
+   max = count - p_srv->pool_size;
+   if (max < 1) {
+      result = p_srv->pool_size;
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return result;
+   }
+   p_warm = (MGWARM *) mg_malloc(sizeof(MGWARM) * max, 0);
+   if (p_warm == NULL) {
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return -1;
+   }
+   count = 0;
+   for (n = 0; n < MG_MAXCON && count < max; n ++) {
+      if (!p_srv->pcon[n]) {
+         p_warm[count].pcon = mg_pool_reserve(p_srv, n);
+         if (!p_warm[count].pcon) {
+            break;
+         }
+         p_warm[count].p_srv = p_srv;
+         p_warm[count].global = global;
+         p_warm[count].result = 0;
+         count ++;
+      }
+   }
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   for (n = 0; n < count; n ++) {
+#if defined(_WIN32)
+      p_warm[n].thread = CreateThread(NULL, 0, mg_pool_warm_thread, (LPVOID) &p_warm[n], 0, NULL);
+      p_warm[n].started = (p_warm[n].thread != NULL);
+#else
+      p_warm[n].started = (pthread_create(&(p_warm[n].thread), NULL, mg_pool_warm_thread, (void *) &p_warm[n]) == 0);
+#endif
+      if (!p_warm[n].started) {
+         mg_pool_warm_thread((void *) &p_warm[n]);
+      }
+   }
+
+   for (n = 0; n < count; n ++) {
+      if (p_warm[n].started) {
+#if defined(_WIN32)
+         WaitForSingleObject(p_warm[n].thread, INFINITE);
+         CloseHandle(p_warm[n].thread);
+#else
+         pthread_join(p_warm[n].thread, NULL);
+#endif
+      }
+      /* Connections that could not be opened have already given back their slot */
+      if (p_warm[n].result) {
+         mg_db_disconnect(p_srv, p_warm[n].pcon->chndle, 1);
+      }
+   }
+
+   mg_free((void *) p_warm, 0);
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   result = p_srv->pool_size;
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   return result;
+}
+
+
+/* v1.3.18: open one connection for mg_pool_warm() and, optionally, make a first ($Data) request over it */
+#if defined(_WIN32)
+DWORD WINAPI mg_pool_warm_thread(LPVOID p_parameters)
+#else
+void * mg_pool_warm_thread(void *p_parameters)
+#endif
+{
+   int chndle;
+   MGWARM *p_warm;
+   MGBUF request;
+
+   p_warm = (MGWARM *) p_parameters;
+
+   if (!mg_pool_open(p_warm->p_srv, p_warm->pcon)) {
+      p_warm->result = 0;
+#if defined(_WIN32)
+      return 0;
+#else
+      return NULL;
+#endif
+   }
+
+   p_warm->result = 1;
+   p_warm->pcon->keep_alive = 1;
+
+   if (p_warm->global && p_warm->global[0]) {
+      chndle = p_warm->pcon->chndle;
+      mg_buf_init(&request, 1024, 1024);
+      mg_request_header(p_warm->p_srv, &request, "D", p_warm->p_srv->product);
+      mg_request_add(p_warm->p_srv, chndle, &request, (unsigned char *) p_warm->global, (int) strlen(p_warm->global), 0, MG_TX_DATA);
+      mg_request_size(p_warm->p_srv, &request);
+      if (!mg_db_send(p_warm->p_srv, chndle, &request, 1) || mg_db_receive(p_warm->p_srv, chndle, &request, 1024, 0) < MG_RECV_HEAD) {
+         p_warm->pcon->keep_alive = 0;
+      }
+      mg_buf_free(&request);
+   }
+
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
+#endif
+}
+
+
+/* v1.3.18: start (or reconfigure) the thread that checks the idle connections in the pool every interval seconds */
+int mg_health_start(MGSRV *p_srv, int interval, int timeout)
+{
+   int rc;
+
+   if (interval < 1) {
+      return mg_health_stop(p_srv);
+   }
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   p_srv->health_interval = interval;
+   p_srv->health_timeout = timeout;
+   if (p_srv->health_running) {
+      mg_cond_signal(&(p_srv->health_cond));
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      return 1;
+   }
+   p_srv->health_running = 1;
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+#if defined(_WIN32)
+   p_srv->health_thread = CreateThread(NULL, 0, mg_health_thread, (LPVOID) p_srv, 0, NULL);
+   rc = (p_srv->health_thread != NULL);
+#else
+   rc = (pthread_create(&(p_srv->health_thread), NULL, mg_health_thread, (void *) p_srv) == 0);
+#endif
+
+   if (!rc) {
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+      p_srv->health_interval = 0;
+      p_srv->health_running = 0;
+      mg_leave_critical_section((void *) &dbx_global_mutex);
       return 0;
    }
 
    return 1;
+}
 
+
+/* v1.3.18: stop the health check thread and wait for it to finish */
+int mg_health_stop(MGSRV *p_srv)
+{
+   int running;
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   running = p_srv->health_running;
+   p_srv->health_interval = 0;
+   p_srv->health_running = 0;
+   if (running) {
+      mg_cond_signal(&(p_srv->health_cond));
+   }
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   if (running) {
+#if defined(_WIN32)
+      WaitForSingleObject(p_srv->health_thread, INFINITE);
+      CloseHandle(p_srv->health_thread);
+#else
+      pthread_join(p_srv->health_thread, NULL);
+#endif
+   }
+
+   return 1;
+}
+
+
+/* v1.3.18: close connections that have been idle for too long, ping (mg_db_ayt) those idle for at least the check interval, */
+/*          and replace any that fail to respond; returns the number of connections that failed */
+int mg_health_check(MGSRV *p_srv)
+{
+   int n, chndle, ok, failed, target;
+   double start;
+   DBXCON *pcon;
+
+   failed = 0;
+   start = mg_time();
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   while ((pcon = mg_pool_evict(p_srv, start))) {
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      mg_db_close(pcon);
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+   }
+
+   for (;;) {
+      pcon = NULL;
+      for (n = 0; n < p_srv->pool_free; n ++) {
+         pcon = p_srv->pcon[p_srv->pool_stack[n]];
+         if (pcon->checked < start && (start - pcon->idle_since) >= (double) p_srv->health_interval) {
+            break;
+         }
+         pcon = NULL;
+      }
+      if (!pcon) {
+         break;
+      }
+
+      /* Take the connection out of the pool while it is checked */
+      for (; n < (p_srv->pool_free - 1); n ++) {
+         p_srv->pool_stack[n] = p_srv->pool_stack[n + 1];
+      }
+      p_srv->pool_free --;
+      pcon->in_use = 1;
+      pcon->eod = 0;
+      chndle = pcon->chndle;
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+
+      ok = mg_db_ayt(p_srv, chndle, p_srv->health_timeout);
+
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+      pcon->checked = mg_time();
+      pcon->in_use = 0;
+      if (ok) {
+         /* Return it to the bottom of the stack: it is still the least recently used */
+         for (n = p_srv->pool_free; n > 0; n --) {
+            p_srv->pool_stack[n] = p_srv->pool_stack[n - 1];
+         }
+         p_srv->pool_stack[0] = chndle;
+         p_srv->pool_free ++;
+         pcon = NULL;
+      }
+      else {
+         p_srv->pcon[chndle] = NULL;
+         p_srv->pool_size --;
+         failed ++;
+      }
+      if (p_srv->pool_waiting) {
+         mg_pool_signal(p_srv);
+      }
+      if (pcon) {
+         mg_leave_critical_section((void *) &dbx_global_mutex);
+         mg_db_close(pcon);
+         mg_enter_critical_section((void *) &dbx_global_mutex);
+      }
+   }
+
+   target = p_srv->pool_size + failed;
+   if (target < p_srv->pool_min) {
+      target = p_srv->pool_min;
+   }
+   n = p_srv->pool_size;
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   if (target > n) {
+      mg_pool_warm(p_srv, target, NULL);
+   }
+
+   return failed;
+}
+
+
+/* v1.3.18 */
+#if defined(_WIN32)
+DWORD WINAPI mg_health_thread(LPVOID p_parameters)
+#else
+void * mg_health_thread(void *p_parameters)
+#endif
+{
+   MGSRV *p_srv;
+
+   p_srv = (MGSRV *) p_parameters;
+
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   while (p_srv->health_interval > 0) {
+      /* A signal means that the thread has been reconfigured or stopped */
+      if (mg_cond_wait(&(p_srv->health_cond), p_srv->health_interval * 1000)) {
+         continue;
+      }
+      if (p_srv->health_interval < 1) {
+         break;
+      }
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      mg_health_check(p_srv);
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+   }
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+#if defined(_WIN32)
+   return 0;
+#else
+   return NULL;
+#endif
 }
 
 
 int mg_db_disconnect(MGSRV *p_srv, int chndle, short context)
 {
+   int keep;
    DBXCON *pcon;
 
    if (p_srv->mode == 2) {
       return 1;
    }
 
-   if (!p_srv->pcon[chndle])
+   if (chndle < 0 || chndle >= MG_MAXCON || !p_srv->pcon[chndle])
       return 0;
 
-   if (p_srv->mode == 1) {
-      p_srv->pcon[chndle]->in_use = 0;
+   pcon = p_srv->pcon[chndle];
+   keep = ((p_srv->mode == 1 || context == 1) && pcon->keep_alive);
+
+   /* v1.3.18: return the connection to the pool, unless the pool has since been made smaller or closed */
+   /*          (or hold it for the thread if a transaction is open on it) */
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   if (!pcon->in_use) {
+      mg_leave_critical_section((void *) &dbx_global_mutex);
       return 1;
    }
+   pcon->in_use = 0;
+   if (pcon->pinned) {
+      pcon->pinned = 0;
+      p_srv->pool_pinned --;
+   }
+   if (keep && !p_srv->pool_closed && (pcon->tlevel > 0 || p_srv->pool_size <= p_srv->pool_max)) {
+      pcon->idle_since = mg_time();
+      if (pcon->tlevel > 0) {
+         /* Held for the thread until its transaction ends: off the stack, so it is neither given to other threads nor evicted or checked */
+         pcon->pinned = 1;
+         pcon->tthread = mg_current_thread_id();
+         p_srv->pool_pinned ++;
+      }
+      else {
+         p_srv->pool_stack[p_srv->pool_free] = chndle;
+         p_srv->pool_free ++;
+      }
+      pcon = NULL;
+   }
+   else {
+      p_srv->pcon[chndle] = NULL;
+      p_srv->pool_size --;
+   }
+   if (p_srv->pool_waiting) {
+      mg_pool_signal(p_srv);
+   }
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   if (pcon) {
+      mg_db_close(pcon);
+   }
 
-   if (context == 1 && p_srv->pcon[chndle]->keep_alive) {
-      p_srv->pcon[chndle]->in_use = 0;
-      return 1;
-   }
+   return 1;
+}
 
-   pcon = p_srv->pcon[chndle];
 
+/* v1.3.18 */
+int mg_db_close(DBXCON *pcon)
+{
 #if defined(_WIN32)
    NETX_CLOSESOCKET(pcon->cli_socket);
    NETX_WSACLEANUP();
@@ -7749,8 +9039,10 @@ int mg_db_disconnect(MGSRV *p_srv, int chndle, short context)
    close(pcon->cli_socket);
 #endif
 
-   mg_free((void *) p_srv->pcon[chndle], 0);
-   p_srv->pcon[chndle] = NULL;
+   if (pcon->pmeth_base) {
+      mg_free((void *) pcon->pmeth_base, 0);
+   }
+   mg_free((void *) pcon, 0);
 
    return 1;
 }
@@ -7759,7 +9051,6 @@ int mg_db_send(MGSRV *p_srv, int chndle, MGBUF *p_buf, int mode)
 {
    int result, n, n1, len, total;
    char *request;
-   unsigned char esize[8];
    DBXCON *pcon;
 
    result = 1;
@@ -7772,8 +9063,7 @@ int mg_db_send(MGSRV *p_srv, int chndle, MGBUF *p_buf, int mode)
    }
 
    if (mode) {
-      len = mg_encode_size(esize, p_buf->data_size - p_srv->header_len, MG_CHUNK_SIZE_BASE);
-      strncpy((char *) (p_buf->p_buffer + (p_srv->header_len - 6) + (5 - len)), (char *) esize, len);
+      mg_request_size(p_srv, p_buf);
    }
 
    if (p_srv->mode == 2) {
@@ -7784,6 +9074,13 @@ int mg_db_send(MGSRV *p_srv, int chndle, MGBUF *p_buf, int mode)
 
    pcon->eod = 0;
 
+   if (p_buf->p_iov && p_buf->p_iov->count) {
+      result = mg_db_send_iov(pcon, p_buf);
+      p_buf->p_iov->count = 0;
+      p_buf->p_iov->size = 0;
+      return result;
+   }
+
    request = (char *) p_buf->p_buffer;
    len = p_buf->data_size;
 
@@ -7812,12 +9109,86 @@ int mg_db_send(MGSRV *p_srv, int chndle, MGBUF *p_buf, int mode)
 }
 
 
+/* v1.3.18: send a request whose larger elements are held in the caller's memory (p_buf->p_iov) without first copying them into the request buffer */
+int mg_db_send_iov(DBXCON *pcon, MGBUF *p_buf)
+{
+   int n, count, next;
+   unsigned long offset;
+   MGIOV *p_iov;
+#if defined(_WIN32)
+   int total;
+   struct {
+      char *         iov_base;
+      unsigned long  iov_len;
+   } iov[MG_IOV_MAX * 2 + 1];
+#else
+   ssize_t sent;
+   struct iovec iov[MG_IOV_MAX * 2 + 1];
+#endif
+
+   p_iov = p_buf->p_iov;
+
+   /* Interleave the parts of the request buffer with the elements referenced from it */
+   count = 0;
+   offset = 0;
+   for (n = 0; n < p_iov->count; n ++) {
+      if (p_iov->offset[n] > offset) {
+         iov[count].iov_base = (char *) p_buf->p_buffer + offset;
+         iov[count].iov_len = p_iov->offset[n] - offset;
+         count ++;
+      }
+      iov[count].iov_base = (char *) p_iov->data[n].ps;
+      iov[count].iov_len = p_iov->data[n].size;
+      count ++;
+      offset = p_iov->offset[n];
+   }
+   if (p_buf->data_size > offset) {
+      iov[count].iov_base = (char *) p_buf->p_buffer + offset;
+      iov[count].iov_len = p_buf->data_size - offset;
+      count ++;
+   }
+
+#if defined(_WIN32)
+   for (next = 0; next < count; next ++) {
+      total = 0;
+      while (total < (int) iov[next].iov_len) {
+         n = NETX_SEND(pcon->cli_socket, iov[next].iov_base + total, (int) iov[next].iov_len - total, 0);
+         if (n < 0) {
+            return 0;
+         }
+         total += n;
+      }
+   }
+#else
+   next = 0;
+   while (next < count) {
+      sent = writev(pcon->cli_socket, iov + next, count - next);
+      if (sent < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         return 0;
+      }
+      while (next < count && (size_t) sent >= iov[next].iov_len) {
+         sent -= (ssize_t) iov[next].iov_len;
+         next ++;
+      }
+      if (next < count) {
+         iov[next].iov_base = (char *) iov[next].iov_base + sent;
+         iov[next].iov_len -= (size_t) sent;
+      }
+   }
+#endif
+
+   return 1;
+}
+
+
 int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
 {
-   int result, n;
+   int result, n, head;
    unsigned long len, total, ssize;
-   fd_set rset, eset;
-   struct timeval tval;
+   double start;
    DBXCON *pcon;
    unsigned long spin_count;
 
@@ -7834,8 +9205,6 @@ int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
 
    /* v1.2.8 */
    pcon->timeout = p_srv->timeout;
-   tval.tv_sec = pcon->timeout;
-   tval.tv_usec = 0;
 
    if (pcon->eod) {
       pcon->eod = 0;
@@ -7844,8 +9213,9 @@ int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
    pcon->eod = 0;
 
    len = 0;
+   head = 0;
 
-   if (mode)
+   if (mode == 1)
       total = size;
    else
       total = p_buf->size;
@@ -7854,30 +9224,38 @@ int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
    for (;;) {
       spin_count ++;
 
-      if (pcon->timeout) {
-         FD_ZERO(&rset);
-         FD_ZERO(&eset);
-         FD_SET(pcon->cli_socket, &rset);
-         FD_SET(pcon->cli_socket, &eset);
+      /* v1.3.18: optionally spin on a non-blocking receive while waiting for the response to start, before blocking */
+      n = -2;
+      if (p_srv->spin_max > 0 && len == 0) {
+         if (pcon->spin_max != p_srv->spin_max) {
+            netx_tcp_spin_tune(pcon, p_srv->spin_max, 0);
+         }
+         start = mg_time();
+         n = netx_tcp_spin(pcon, p_buf->p_buffer, (int) total, pcon->spin);
+         netx_tcp_spin_tune(pcon, p_srv->spin_max, (n == -2) ? -1 : (int) ((mg_time() - start) * 1000000));
+      }
 
-         n = NETX_SELECT((int) (pcon->cli_socket + 1), &rset, NULL, &eset, &tval);
+      if (n == -2) {
+         if (pcon->timeout) {
+            n = netx_tcp_poll(pcon, 0, pcon->timeout * 1000); /* v1.3.18 */
 
-         if (n == 0) {
-            sprintf(pcon->error, "TCP Read Error: Server did not respond within the timeout period (%d seconds)", pcon->timeout);
-            result = NETX_READ_TIMEOUT;
-            pcon->eod = 1;
-            break;
-         }
+            if (n == 0) {
+               sprintf(pcon->error, "TCP Read Error: Server did not respond within the timeout period (%d seconds)", pcon->timeout);
+               result = NETX_READ_TIMEOUT;
+               pcon->eod = 1;
+               break;
+            }
 
-         if (n < 0 || !NETX_FD_ISSET(pcon->cli_socket, &rset)) {
-            strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned any data");
-            result = NETX_READ_ERROR;
-            pcon->eod = 1;
-            break;
+            if (n < 0) {
+               strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned any data");
+               result = NETX_READ_ERROR;
+               pcon->eod = 1;
+               break;
+            }
          }
-      }
 
-      n = NETX_RECV(pcon->cli_socket, p_buf->p_buffer + len, total - len, 0);
+         n = NETX_RECV(pcon->cli_socket, p_buf->p_buffer + len, total - len, 0);
+      }
 
       if (n < 0) {
          result = len;
@@ -7896,18 +9274,24 @@ int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
       p_buf->p_buffer[len] = '\0';
       result = len;
 
-      if (!ssize && p_buf->data_size >= MG_RECV_HEAD) {
+      if (!head && p_buf->data_size >= MG_RECV_HEAD) {
+         head = 1;
          ssize = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
          total = ssize + MG_RECV_HEAD;
 
-         if (ssize && (ssize + MG_RECV_HEAD) > total) {
+         if (ssize && (ssize + MG_RECV_HEAD) >= p_buf->size) { /* v1.3.18 */
+            if (mode == 2) {
+               /* v1.3.18: leave the rest of a response that does not fit the buffer to be read by mg_db_receive_rest() */
+               result = len;
+               break;
+            }
             if (!mg_buf_resize(p_buf, ssize + MG_RECV_HEAD + 32)) {
                p_srv->mem_error = 1;
                break;
             }
          }
       }
-      if (!ssize || len >= total) {
+      if ((head && !ssize) || len >= total) { /* v1.3.18: wait for the whole header */
          p_buf->p_buffer[len] = '\0';
          result = len;
          pcon->eod = 1;
@@ -7928,6 +9312,97 @@ int mg_db_receive(MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode)
 }
 
 
+/* v1.3.18: read the rest of a response left unread by mg_db_receive() (mode 2) */
+/*          the response data is received straight into data (size bytes) or, if data is NULL, into the buffer itself */
+int mg_db_receive_rest(MGSRV *p_srv, int chndle, MGBUF *p_buf, unsigned char *data)
+{
+   int n;
+   unsigned long len, ssize;
+   DBXCON *pcon;
+
+   if (p_srv->mode == 2 || p_buf->data_size < MG_RECV_HEAD) {
+      return 0;
+   }
+
+   pcon = p_srv->pcon[chndle];
+
+   ssize = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
+   len = p_buf->data_size - MG_RECV_HEAD;
+   if (len > ssize) {
+      len = ssize;
+   }
+
+   if (data) {
+      memcpy((void *) data, (void *) (p_buf->p_buffer + MG_RECV_HEAD), len);
+   }
+   else {
+      if (!mg_buf_resize(p_buf, ssize + MG_RECV_HEAD + 32)) {
+         p_srv->mem_error = 1;
+         return 0;
+      }
+      data = p_buf->p_buffer + MG_RECV_HEAD;
+   }
+
+   while (len < ssize) {
+      if (pcon->timeout) {
+         n = netx_tcp_poll(pcon, 0, pcon->timeout * 1000);
+         if (n == 0) {
+            sprintf(pcon->error, "TCP Read Error: Server did not respond within the timeout period (%d seconds)", pcon->timeout);
+            break;
+         }
+         if (n < 0) {
+            strcpy(pcon->error, "TCP Read Error: Server closed the connection without having returned all the data");
+            break;
+         }
+      }
+      n = NETX_RECV(pcon->cli_socket, data + len, ssize - len, 0);
+      if (n < 1) {
+         break;
+      }
+      len += n;
+   }
+
+   if (data == p_buf->p_buffer + MG_RECV_HEAD) {
+      p_buf->data_size = MG_RECV_HEAD + len;
+      p_buf->p_buffer[p_buf->data_size] = '\0';
+   }
+   pcon->eod = 1;
+
+   if (len < ssize) {
+      pcon->keep_alive = 0;
+      return 0;
+   }
+
+   return 1;
+}
+
+
+/* v1.3.18: receive the next of several responses to requests sent together (pipelined): read no further than the end of this response */
+int mg_db_receive_next(MGSRV *p_srv, int chndle, MGBUF *p_buf)
+{
+   int result;
+#if defined(TCP_QUICKACK)
+   int flag;
+#endif
+
+   if (p_srv->mode == 2) {
+      return 0;
+   }
+
+   p_srv->pcon[chndle]->eod = 0;
+
+   result = mg_db_receive(p_srv, chndle, p_buf, MG_RECV_HEAD, 1);
+
+#if defined(TCP_QUICKACK)
+   /* Acknowledge each response straight away: a DB Server using Nagle's algorithm holds back the next response until it does */
+   flag = 1;
+   NETX_SETSOCKOPT(p_srv->pcon[chndle]->cli_socket, IPPROTO_TCP, TCP_QUICKACK, (const char *) &flag, sizeof(int));
+#endif
+
+   return result;
+}
+
+
 int mg_db_connect_init(MGSRV *p_srv, int chndle)
 {
    int result, n, buffer_actual_size, child_port;
@@ -7963,6 +9438,7 @@ int mg_db_connect_init(MGSRV *p_srv, int chndle)
 
       p = strstr(buffer, "pid=");
       if (!p) {
+         mg_buf_free(&request); /* v1.3.18 */
          return 2;
       }
       if (p) {
@@ -8038,11 +9514,13 @@ int mg_db_connect_init(MGSRV *p_srv, int chndle)
       }
    }
 
+   mg_buf_free(&request); /* v1.3.18 */
+
    return result;
 }
 
 
-int mg_db_ayt(MGSRV *p_srv, int chndle)
+int mg_db_ayt(MGSRV *p_srv, int chndle, int timeout)
 {
    int result, n, buffer_actual_size;
    char buffer[512];
@@ -8060,9 +9538,20 @@ int mg_db_ayt(MGSRV *p_srv, int chndle)
    strcpy(buffer, "^A^A0123456789^^^^^\n");
    mg_buf_cpy(&request, buffer, (int) strlen(buffer));
 
-   n = mg_db_send(p_srv, chndle, &request, 1);
+   n = mg_db_send(p_srv, chndle, &request, 0); /* v1.3.18: not a framed request: there is no size to fill in */
+   if (!n) {
+      mg_buf_free(&request);
+      return 0;
+   }
 
-   strcpy(buffer, "");
+   /* v1.3.18: wait no longer than timeout (msecs) for the response to start */
+   if (timeout > 0) {
+      n = netx_tcp_poll(p_srv->pcon[chndle], 0, timeout);
+      if (n < 1) {
+         mg_buf_free(&request);
+         return 0;
+      }
+   }
 
    n = mg_db_receive(p_srv, chndle, &request, 1024, 0);
 
@@ -8070,13 +9559,12 @@ int mg_db_ayt(MGSRV *p_srv, int chndle)
       buffer_actual_size += n;
    }
 
-   strcpy(buffer, (char *) request.p_buffer);
-   buffer[buffer_actual_size] = '\0';
-
    if (buffer_actual_size > 0) {
       result = 1;
    }
 
+   mg_buf_free(&request); /* v1.3.18 */
+
    return result;
 }
 
@@ -8108,6 +9596,11 @@ int mg_request_header(MGSRV *p_srv, MGBUF *p_buf, char *command, char *product)
 
    mg_buf_cpy(p_buf, buffer, (int) strlen(buffer));
 
+   if (p_buf->p_iov) {
+      p_buf->p_iov->count = 0;
+      p_buf->p_iov->size = 0;
+   }
+
    return 1;
 }
 
@@ -8124,6 +9617,17 @@ int mg_request_add(MGSRV *p_srv, int chndle, MGBUF *p_buf, unsigned char *elemen
    }
    hlen = mg_encode_item_header(head, size, byref, type);
    mg_buf_cat(p_buf, (char *) head, hlen);
+
+   /* v1.3.18: large elements are sent from where they are (mg_db_send_iov) rather than copied, where the caller has asked for this */
+   if (p_buf->p_iov && p_buf->p_iov->count < MG_IOV_MAX && size >= MG_IOV_MIN && p_srv->mode != 2) {
+      p_buf->p_iov->offset[p_buf->p_iov->count] = p_buf->data_size;
+      p_buf->p_iov->data[p_buf->p_iov->count].ps = element;
+      p_buf->p_iov->data[p_buf->p_iov->count].size = (unsigned int) size;
+      p_buf->p_iov->count ++;
+      p_buf->p_iov->size += (unsigned long) size;
+      return 1;
+   }
+
    if (size)
       mg_buf_cat(p_buf, (char *) element, size);
    return 1;
@@ -8164,6 +9668,56 @@ int mg_request_add(MGSRV *p_srv, int chndle, MGBUF *p_buf, unsigned char *elemen
 }
 
 
+/* v1.3.18 */
+unsigned long mg_request_add_size(int size, short byref, short type)
+{
+   int hlen;
+   unsigned char head[16];
+
+   if (type == MG_TX_AREC_FORMATTED) {
+      return (unsigned long) size;
+   }
+   hlen = mg_encode_item_header(head, size, byref, type);
+
+   return (unsigned long) (hlen + size);
+}
+
+
+/* v1.3.18: record the payload size of a complete request in its header */
+int mg_request_size(MGSRV *p_srv, MGBUF *p_buf)
+{
+   int len;
+   unsigned long size;
+   unsigned char esize[8];
+
+   size = p_buf->data_size - p_srv->header_len;
+   if (p_buf->p_iov) {
+      size += p_buf->p_iov->size;
+   }
+   len = mg_encode_size(esize, (int) size, MG_CHUNK_SIZE_BASE);
+   strncpy((char *) (p_buf->p_buffer + (p_srv->header_len - 6) + (5 - len)), (char *) esize, len);
+
+   return 1;
+}
+
+
+int mg_request_stream(MGSRV *p_srv, MGBUF *p_buf, unsigned long size)
+{
+   int len;
+   unsigned char esize[8];
+
+   /* Record the payload size in the request header up front so that the request can be sent in chunks (mg_db_send mode 0) as it is built */
+   if (p_srv->mode == 2 || size < MG_STREAM_CHUNK || size > MG_STREAM_MAX) {
+      return 0;
+   }
+
+   len = mg_encode_size(esize, (int) size, MG_CHUNK_SIZE_BASE);
+   strncpy((char *) (p_buf->p_buffer + (p_srv->header_len - 6) + (5 - len)), (char *) esize, len);
+
+   return 1;
+}
+
+
 int mg_encode_size64(int n10)
 {
    if (n10 >= 0 && n10 < 10)
@@ -8854,3 +10408,189 @@ mg_invoke_server_api_exit:
    return result;
 }
 
+
+/* v1.3.18 */
+int mg_server_api_global(MGSRV *p_srv)
+{
+   DBXCON *pcon;
+
+   if (p_srv->mode != 2 || !p_srv->pcon[0]) {
+      return 0;
+   }
+
+   pcon = p_srv->pcon[0];
+   if (!pcon->connected || !pcon->pmeth_base) {
+      return 0;
+   }
+
+   if (pcon->dbtype == DBX_DBTYPE_YOTTADB && pcon->p_ydb_so && pcon->p_ydb_so->loaded) {
+      return 1;
+   }
+   if (pcon->dbtype != DBX_DBTYPE_YOTTADB && pcon->p_isc_so && pcon->p_isc_so->loaded) {
+      return 1;
+   }
+
+   return 0;
+}
+
+
+/* v1.3.18 */
+int mg_invoke_server_api_global(MGSRV *p_srv, int chndle, char command, char *global, MGSTR *args, int argc, MGBUF *p_buf)
+{
+   int rc, rc1, n, len, retry, mem_error;
+   char gname[256];
+   DBXSTR output_val;
+   DBXMETH *pmeth;
+   DBXCON *pcon;
+
+   chndle = 0;
+   pcon = p_srv->pcon[chndle];
+   pmeth = (DBXMETH *) pcon->pmeth_base;
+   pmeth->pcon = pcon;
+
+   len = (int) strlen(global);
+   if (argc > (DBX_MAXARGS - 2) || len > 250) {
+      strcpy(p_srv->error_mess, "Too many subscripts or global name too long");
+      sprintf((char *) p_buf->p_buffer, "00000ce\n%s", p_srv->error_mess);
+      p_buf->data_size = (int) strlen((char *) p_buf->p_buffer);
+      return 0;
+   }
+
+   /* The SimpleAPI requires the '^' prefix for global names (it is stripped again for CachePushGlobal) */
+   if (global[0] == '^') {
+      strcpy(gname, global);
+   }
+   else {
+      gname[0] = '^';
+      strcpy(gname + 1, global);
+   }
+
+   pmeth->args[0].svalue.buf_addr = gname;
+   pmeth->args[0].svalue.len_used = (unsigned int) strlen(gname);
+   pmeth->args[0].svalue.len_alloc = pmeth->args[0].svalue.len_used;
+   for (n = 0; n < argc; n ++) {
+      pmeth->args[n + 1].type = DBX_DTYPE_STR;
+      pmeth->args[n + 1].svalue.buf_addr = (char *) args[n].ps;
+      pmeth->args[n + 1].svalue.len_used = args[n].size;
+      pmeth->args[n + 1].svalue.len_alloc = args[n].size;
+      pmeth->yargs[n] = pmeth->args[n + 1].svalue;
+   }
+   pmeth->argc = argc + 1;
+   pmeth->command[0] = command;
+   pmeth->command[1] = '\0';
+   pmeth->p_dbxfun = (int (*) (struct tagDBXMETH * pmeth)) ydb_global_ex;
+   strcpy(pcon->error, "");
+
+   /* Results are written straight into the response buffer after its (MG_RECV_HEAD byte) header */
+   output_val = pmeth->output_val.svalue;
+
+   DBX_LOCK(rc1, 0);
+
+   rc = YDB_OK;
+   mem_error = 0;
+   for (retry = 0; retry < 2; retry ++) {
+      pmeth->output_val.svalue.buf_addr = (char *) p_buf->p_buffer + MG_RECV_HEAD;
+      pmeth->output_val.svalue.len_alloc = (unsigned int) (p_buf->size - (MG_RECV_HEAD + 1));
+      pmeth->output_val.svalue.len_used = 0;
+
+      if (pcon->dbtype != DBX_DBTYPE_YOTTADB) {
+         rc = isc_global_ex(pmeth);
+         mg_cleanup(pmeth);
+         if (rc != CACHE_STRTOOLONG || pmeth->output_val.svalue.len_used <= pmeth->output_val.svalue.len_alloc) {
+            break;
+         }
+      }
+      else {
+         if (pcon->tlevel > 0) {
+            ydb_transaction_task(pmeth, YDB_TPCTX_DB);
+            rc = pmeth->output_val.num.int32;
+         }
+         else {
+            rc = ydb_global_ex(pmeth);
+         }
+         if (rc != YDB_ERR_INVSTRLEN) {
+            break;
+         }
+      }
+      if (!mg_buf_resize(p_buf, MG_RECV_HEAD + pmeth->output_val.svalue.len_used + 32)) {
+         mem_error = 1;
+         break;
+      }
+   }
+
+   len = (int) pmeth->output_val.svalue.len_used;
+   pmeth->output_val.svalue = output_val;
+
+   DBX_UNLOCK(rc1);
+
+   if (mem_error) {
+      p_buf->data_size = 0;
+      p_srv->mem_error = 1;
+      return 0;
+   }
+
+   if (rc != YDB_OK) {
+      mg_error_message(pmeth, rc);
+      sprintf((char *) p_buf->p_buffer, "00000ce\n%s", pcon->error);
+      p_buf->data_size = (int) strlen((char *) p_buf->p_buffer);
+      return 0;
+   }
+
+   memcpy((void *) p_buf->p_buffer, (void *) "00000cv\n", MG_RECV_HEAD);
+   p_buf->data_size = MG_RECV_HEAD + len;
+   p_buf->p_buffer[p_buf->data_size] = '\0';
+
+   return 1;
+}
+
+
+/* v1.3.18: next ('N') or previous ('R') subscript together with its data: <key length (4 bytes)><key><data> */
+int mg_global_next_data(DBXMETH *pmeth, int (* p_global_ex) (DBXMETH *pmeth))
+{
+   int rc, last;
+   unsigned int len;
+   char command;
+   DBXSTR output, key;
+
+   command = pmeth->command[0];
+   output = pmeth->output_val.svalue;
+   last = pmeth->argc - 1;
+   key = pmeth->args[last].svalue;
+
+   /* YDB_OK and CACHE_SUCCESS (0) are used interchangeably below, as are YDB_FAILURE and CACHE_FAILURE (-1) */
+   if (last < 1) {
+      pmeth->output_val.svalue.len_used = 0;
+      return YDB_FAILURE;
+   }
+
+   pmeth->command[0] = (command == 'N') ? 'O' : 'P';
+   pmeth->output_val.svalue.buf_addr = output.buf_addr + 4;
+   pmeth->output_val.svalue.len_alloc = output.len_alloc - 4;
+   rc = p_global_ex(pmeth);
+   mg_cleanup(pmeth);
+   len = pmeth->output_val.svalue.len_used;
+
+   if (rc == YDB_OK && len > 0) {
+      /* Get the data held under the subscript found */
+      mg_set_size((unsigned char *) output.buf_addr, (unsigned long) len);
+      pmeth->args[last].svalue.buf_addr = output.buf_addr + 4;
+      pmeth->args[last].svalue.len_used = len;
+      pmeth->args[last].svalue.len_alloc = len;
+      pmeth->yargs[last - 1] = pmeth->args[last].svalue;
+
+      pmeth->command[0] = 'G';
+      pmeth->output_val.svalue.buf_addr = output.buf_addr + 4 + len;
+      pmeth->output_val.svalue.len_alloc = output.len_alloc - (4 + len);
+      rc = p_global_ex(pmeth);
+      len += pmeth->output_val.svalue.len_used;
+   }
+
+   /* Restore the original request so that it can be retried with a larger buffer */
+   pmeth->command[0] = command;
+   pmeth->args[last].svalue = key;
+   pmeth->yargs[last - 1] = key;
+   pmeth->output_val.svalue = output;
+   pmeth->output_val.svalue.len_used = (len > 0) ? (len + 4) : 0;
+
+   return rc;
+}
@@ -90,6 +90,7 @@
 #include <sys/wait.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <sys/resource.h>
 #if !defined(HPUX) && !defined(HPUX10) && !defined(HPUX11)
 #include <sys/select.h>
@@ -97,6 +98,7 @@
 #if defined(SOLARIS)
 #include <sys/filio.h>
 #endif
+#include <poll.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -218,6 +220,13 @@ typedef struct {
 #define YDB_FAILURE -1
 #define YDB_DEL_TREE 1
 
+/* v1.3.18 */
+#define YDB_ERR_GVUNDEF    -150372994
+#define YDB_ERR_LVUNDEF    -150373850
+#define YDB_ERR_INVSTRLEN  -150375522
+#define YDB_ERR_NODEEND    -151027786
+#define YDB_MAX_SUBS       31
+
 typedef int                ydb_int_t;
 typedef unsigned int       ydb_uint_t;
 typedef long               ydb_long_t;
@@ -815,6 +824,18 @@ typedef struct tagDBXMUTEX {
 } DBXMUTEX, *PDBXMUTEX;
 
 
+/* v1.3.18: condition variable used with dbx_global_mutex, and a critical section held by a server */
+#if defined(_WIN32)
+typedef CONDITION_VARIABLE    DBXCOND;
+typedef HANDLE                DBXTHREAD;
+typedef CRITICAL_SECTION      DBXCRIT;
+#else
+typedef pthread_cond_t        DBXCOND;
+typedef pthread_t             DBXTHREAD;
+typedef pthread_mutex_t       DBXCRIT;
+#endif
+
+
 typedef struct tagDBXCVAL {
    void           *pstr;
    CACHE_EXSTR    zstr;
@@ -1046,6 +1067,12 @@ typedef struct tagDBXCON {
    short          keep_alive;
    short          in_use;
    int            chndle;
+   double         idle_since; /* v1.3.18 */
+   double         checked;
+   short          pinned;
+   DBXTHID        tthread;
+   int            spin;
+   int            spin_max;
    int            base_port;
    int            child_port;
    char           mpid[128];
@@ -1114,7 +1141,15 @@ typedef struct tagDBXTHRT {
 #define MG_PRODUCT               "g"
 #endif
 
-#define MG_MAXCON                32
+/* v1.3.18: connections are pooled per server (MGSRV); MG_MAXCON is the ceiling for the pool size */
+#define MG_MAXCON                1024
+#define MG_POOL_MAX              32
+#define MG_POOL_WAIT             30000
+#define MG_HEALTH_TIMEOUT        5000
+
+/* v1.3.18: limits (usecs) for spinning on a non-blocking receive before blocking */
+#define MG_SPIN_MIN              5
+#define MG_SPIN_MAX              1000000
 
 #define MG_TX_DATA               0
 #define MG_TX_AKEY               1
@@ -1130,6 +1165,19 @@ typedef struct tagDBXTHRT {
 #define MG_BUFSIZE               32768
 #define MG_BUFMAX                32767
 
+/* v1.3.18: reusable request/response buffers held by each server (page) */
+#define MG_BUF_CACHE             16
+#define MG_BUF_CACHE_DEFAULT     4
+#define MG_BUF_HIGH_WATER        1048576
+
+/* v1.3.18: large requests are sent in chunks of this size as they are built */
+#define MG_STREAM_CHUNK          262144
+#define MG_STREAM_MAX            916132831
+
+/* v1.3.18: elements of at least MG_IOV_MIN bytes may be sent from the caller's memory rather than copied into the request buffer */
+#define MG_IOV_MAX               8
+#define MG_IOV_MIN               8192
+
 #define MG_ES_DELIM              0
 #define MG_ES_BLOCK              1
 
@@ -1138,6 +1186,7 @@ typedef struct tagMGBUF {
    unsigned long     data_size;
    unsigned long     increment_size;
    unsigned char *   p_buffer;
+   struct tagMGIOV * p_iov;         /* v1.3.18: elements referenced by the request (optional) */
 } MGBUF, *LPMGBUF;
 
 typedef struct tagMGSTR {
@@ -1145,6 +1194,14 @@ typedef struct tagMGSTR {
    unsigned char *   ps;
 } MGSTR, *LPMGSTR;
 
+/* v1.3.18: elements sent from the caller's memory: each belongs at offset[n] in the request buffer */
+typedef struct tagMGIOV {
+   int               count;
+   unsigned long     size;
+   unsigned long     offset[MG_IOV_MAX];
+   MGSTR             data[MG_IOV_MAX];
+} MGIOV, *LPMGIOV;
+
 typedef struct tagMGSRV {
    short       mem_error;
    short       storage_mode;
@@ -1158,7 +1215,7 @@ typedef struct tagMGSRV {
    char        server[64];
    char        uci[128];
    char        shdir[256];
-   char        ip_address[64];
+   char        ip_address[128]; /* v1.3.18: room for unix:<path> */
    int         port;
    int         timeout;
    int         no_retry;
@@ -1171,8 +1228,41 @@ typedef struct tagMGSRV {
    MGBUF *     p_params;
    DBXLOG *    p_log;
    PDBXCON     pcon[MG_MAXCON];
+   int         buf_high_water; /* v1.3.18 */
+   int         buf_cache_max;
+   int         buf_cache_count;
+   DBXCRIT     buf_cache_lock;
+   MGBUF       buf_cache[MG_BUF_CACHE];
+   int         pool_min; /* v1.3.18 */
+   int         pool_max;
+   int         pool_wait;
+   int         pool_idle;
+   int         pool_size;
+   int         pool_free;
+   int         pool_waiting;
+   int         pool_closed;
+   int         pool_pinned;
+   int         pool_stack[MG_MAXCON];
+   DBXCOND     pool_cond;
+   int         health_interval;
+   int         health_timeout;
+   int         health_running;
+   DBXCOND     health_cond;
+   DBXTHREAD   health_thread;
+   int         spin_max;
+   int         in_flight; /* v1.3.18: calls waiting on the DB Server with the GIL released (maintained by mg_python under the GIL) */
 } MGSRV, *LPMGSRV;
 
+/* v1.3.18: a connection being opened by mg_pool_warm() */
+typedef struct tagMGWARM {
+   MGSRV *     p_srv;
+   DBXCON *    pcon;
+   char *      global;
+   int         result;
+   int         started;
+   DBXTHREAD   thread;
+} MGWARM, *LPMGWARM;
+
 
 #if defined(_WIN32)
 extern CRITICAL_SECTION  dbx_global_mutex;
@@ -1252,6 +1342,8 @@ int                     isc_open                      (DBXMETH *pmeth);
 int                     isc_parse_zv                  (char *zv, DBXZV * p_isc_sv);
 int                     isc_change_namespace          (DBXCON *pcon, char *nspace);
 int                     isc_pop_value                 (DBXCON *pcon, DBXVAL *value, int required_type);
+int                     isc_push_subscript            (DBXCON *pcon, DBXVAL *arg);
+int                     isc_global_ex                 (DBXMETH *pmeth);
 int                     isc_error_message             (DBXMETH *pmeth, int error_code);
 
 int                     ydb_load_library              (DBXCON *pcon);
@@ -1261,6 +1353,8 @@ int                     ydb_get_intsvar               (DBXCON *pcon, char *svarn
 int                     ydb_error_message             (DBXMETH *pmeth, int error_code);
 int                     ydb_function                  (DBXMETH *pmeth, DBXFUN *pfun);
 int                     ydb_function_ex               (DBXMETH *pmeth, DBXFUN *pfun);
+int                     ydb_global_ex                 (DBXMETH *pmeth);
+int                     ydb_query_ex                  (DBXMETH *pmeth);
 int                     ydb_transaction_cb            (void *pargs);
 #if defined(_WIN32)
 LPTHREAD_START_ROUTINE  ydb_transaction_thread        (LPVOID pargs);
@@ -1294,6 +1388,9 @@ int                     mg_buf_resize                 (MGBUF *p_buf, unsigned lo
 int                     mg_buf_free                   (MGBUF *p_buf);
 int                     mg_buf_cpy                    (MGBUF *p_buf, char * buffer, unsigned long size);
 int                     mg_buf_cat                    (MGBUF *p_buf, char * buffer, unsigned long size);
+int                     mg_buf_get                    (MGSRV *p_srv, MGBUF *p_buf);
+int                     mg_buf_release                (MGSRV *p_srv, MGBUF *p_buf);
+int                     mg_buf_cache_free             (MGSRV *p_srv, int max);
 
 void *                  mg_realloc                    (void *p, int curr_size, int new_size, short id);
 void *                  mg_malloc                     (int size, short id);
@@ -1326,31 +1423,71 @@ int                     mg_enter_critical_section     (void *p_crit);
 int                     mg_leave_critical_section     (void *p_crit);
 
 int                     mg_sleep                      (unsigned long msecs);
+double                  mg_time                       (void);
 
 int                     netx_load_winsock             (DBXCON *pcon, int context);
 int                     netx_tcp_connect              (DBXCON *pcon, int context);
 int                     netx_tcp_handshake            (DBXCON *pcon, int context);
 int                     netx_tcp_command              (DBXMETH *pmeth, int context);
 int                     netx_tcp_connect_ex           (DBXCON *pcon, xLPSOCKADDR p_srv_addr, socklen_netx srv_addr_len, int timeout);
+int                     netx_unix_connect             (DBXCON *pcon, char *path);
 int                     netx_tcp_disconnect           (DBXCON *pcon, int context);
 int                     netx_tcp_write                (DBXCON *pcon, unsigned char *data, int size);
 int                     netx_tcp_read                 (DBXCON *pcon, unsigned char *data, int size, int timeout, int context);
+int                     netx_tcp_poll                 (DBXCON *pcon, int write, int timeout);
+int                     netx_tcp_spin                 (DBXCON *pcon, unsigned char *data, int size, int usecs);
+int                     netx_tcp_spin_tune            (DBXCON *pcon, int spin_max, int usecs);
 int                     netx_get_last_error           (int context);
 int                     netx_get_error_message        (int error_code, char *message, int size, int context);
 int                     netx_get_std_error_message    (int error_code, char *message, int size, int context);
 
 
 int                     mg_db_command                 (DBXMETH *pmeth, int context);
+int                     mg_cond_init                  (DBXCOND *p_cond);
+int                     mg_cond_wait                  (DBXCOND *p_cond, int msecs);
+int                     mg_cond_signal                (DBXCOND *p_cond);
+int                     mg_cond_destroy               (DBXCOND *p_cond);
+int                     mg_pool_init                  (MGSRV *p_srv);
+int                     mg_pool_close                 (MGSRV *p_srv);
+int                     mg_pool_destroy               (MGSRV *p_srv);
+int                     mg_pool_wait                  (MGSRV *p_srv, int msecs);
+int                     mg_pool_signal                (MGSRV *p_srv);
+DBXCON *                mg_pool_evict                 (MGSRV *p_srv, double now);
+DBXCON *                mg_pool_pinned                (MGSRV *p_srv, DBXTHID tid);
+int                     mg_pool_transaction           (MGSRV *p_srv, int chndle, char *command, MGBUF *p_buf);
+DBXCON *                mg_pool_reserve               (MGSRV *p_srv, int chndle);
+int                     mg_pool_open                  (MGSRV *p_srv, DBXCON *pcon);
+int                     mg_pool_warm                  (MGSRV *p_srv, int count, char *global);
+#if defined(_WIN32)
+DWORD WINAPI            mg_pool_warm_thread           (LPVOID p_parameters);
+#else
+void *                  mg_pool_warm_thread           (void *p_parameters);
+#endif
+int                     mg_health_start               (MGSRV *p_srv, int interval, int timeout);
+int                     mg_health_stop                (MGSRV *p_srv);
+int                     mg_health_check               (MGSRV *p_srv);
+#if defined(_WIN32)
+DWORD WINAPI            mg_health_thread              (LPVOID p_parameters);
+#else
+void *                  mg_health_thread              (void *p_parameters);
+#endif
 int                     mg_db_connect                 (MGSRV *p_srv, int *chndle, short context);
+int                     mg_db_close                   (DBXCON *pcon);
 int                     mg_db_disconnect              (MGSRV *p_srv, int chndle, short context);
 int                     mg_db_send                    (MGSRV *p_srv, int chndle, MGBUF *p_buf, int mode);
+int                     mg_db_send_iov                (DBXCON *pcon, MGBUF *p_buf);
 int                     mg_db_receive                 (MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode);
+int                     mg_db_receive_rest            (MGSRV *p_srv, int chndle, MGBUF *p_buf, unsigned char *data);
+int                     mg_db_receive_next            (MGSRV *p_srv, int chndle, MGBUF *p_buf);
 int                     mg_db_connect_init            (MGSRV *p_srv, int chndle);
-int                     mg_db_ayt                     (MGSRV *p_srv, int chndle);
+int                     mg_db_ayt                     (MGSRV *p_srv, int chndle, int timeout);
 int                     mg_db_get_last_error          (int context);
 
 int                     mg_request_header             (MGSRV *p_srv, MGBUF *p_buf, char *command, char *product);
 int                     mg_request_add                (MGSRV *p_srv, int chndle, MGBUF *p_buf, unsigned char *element, int size, short byref, short type);
+unsigned long           mg_request_add_size           (int size, short byref, short type);
+int                     mg_request_size               (MGSRV *p_srv, MGBUF *p_buf);
+int                     mg_request_stream             (MGSRV *p_srv, MGBUF *p_buf, unsigned long size);
 
 int                     mg_encode_size64              (int n10);
 int                     mg_decode_size64              (int nxx);
@@ -1367,6 +1504,9 @@ int                     mg_replace_substrings         (char * tbuffer, char *fbu
 int                     mg_bind_server_api            (MGSRV *p_srv, short context);
 int                     mg_release_server_api         (MGSRV *p_srv, short context);
 int                     mg_invoke_server_api          (MGSRV *p_srv, int chndle, MGBUF *p_buf, int size, int mode);
+int                     mg_server_api_global          (MGSRV *p_srv);
+int                     mg_invoke_server_api_global   (MGSRV *p_srv, int chndle, char command, char *global, MGSTR *args, int argc, MGBUF *p_buf);
+int                     mg_global_next_data           (DBXMETH *pmeth, int (* p_global_ex) (DBXMETH *pmeth));
 
 #ifdef __cplusplus
 }
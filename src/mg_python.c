@@ -63,6 +63,56 @@ Version 2.4.49 26 October 2021:
 Version 2.4.49a 23 June 2023:
    Documentation update.
 
+Version 2.4.50 17 October 2026:
+   Release the Python GIL while waiting for the DB Server to respond over network-based connectivity.
+   - Other Python threads may run while a request is in progress.
+   - Connections are claimed from the shared connection table under a lock.
+   Access YottaDB globals directly through the SimpleAPI for API-based connectivity.
+   - m_set, m_get, m_kill, m_data, m_order, m_previous and m_increment no longer pass through ifc^%zmgsis.
+   Access InterSystems IRIS and Cache globals directly through the Call-in interface for API-based connectivity.
+   Reuse request/response buffers held by each server handle instead of allocating a new buffer for every call.
+   - The buffer policy can be adjusted using m_set_buffer_policy(<dbhandle>, <high_water>, <max_buffers>).
+   Stream large ma_merge_to_db requests to the DB Server in chunks instead of building the whole request in memory.
+   - The text of each record is held in scratch space only while the record is measured or added to the request, so the space used does not grow with the number of records.
+   Introduce m_iterate() for fetching the (key, value) pairs under a global node in batches.
+   Introduce m_query() for fetching all the data nodes below a global node (at all levels) in batches.
+   Introduce m_order_data() and m_previous_data() for fetching the next (or previous) key together with its data.
+   Introduce m_batch() for sending a list of global commands to the DB Server together.
+   Pipeline the requests for the data fetched by m_iterate() and m_query() over network-based connectivity.
+   Introduce m_request(), m_response_size() and m_response() for encoding requests and decoding responses in the application's own network code.
+   - An example asyncio client is provided in samples/async_client.py.
+   Pool the network connections for each server handle rather than sharing a table of 32 connections between them all.
+   - The pool can be configured using m_set_connection_pool(<dbhandle>, <min>, <max>[, <wait>[, <idle>]]).
+   - The connections held for a server handle are closed when the handle is released.
+   - A server handle is not released (m_release_page_handle) while another thread is using it: mg_ppage_busy().
+   Introduce m_pool_warm(<dbhandle>, <number>[, <global>]) for opening connections in parallel before they are needed.
+   Introduce m_set_health_check(<dbhandle>, <interval>[, <timeout>]) for checking idle connections in the background.
+   Wait for responses from the DB Server using poll() rather than select() so that processes with many open files are supported.
+   Introduce m_set_receive_spin(<dbhandle>, <usecs>) for spinning before blocking while waiting for a response.
+   Connect to a DB Server listening on a UNIX domain socket using m_set_host(<dbhandle>, "unix:<path>", 0, "", "").
+   Send large values passed to m_set and ma_set directly from the Python object rather than copying them into the request buffer.
+   - Only str and bytes values are sent in place: bytearray, memoryview and other buffers are copied first, since they could change (or be released) while the request is sent.
+   Receive large values returned by m_get and ma_get directly into the Python string returned: mg_receive_pystring().
+   Accept bytes, bytearray, memoryview (and other objects supporting the buffer protocol) for keys and values.
+   - The length of a str is taken as the length of its UTF-8 encoding rather than the number of characters.
+   Introduce m_set_bytes_mode(<dbhandle>, <mode>) for returning data from the DB Server as bytes rather than str.
+   - m_response() takes an optional server handle for the same purpose.
+   Send int values to their full width (not truncated to 32 bits) and float values in canonical M form: mg_canonical_double().
+   - Floats are formatted with the shortest digits that read back as the same value rather than with "%f".
+   Introduce m_set_number_mode(<dbhandle>, <mode>) for returning canonical numbers from the DB Server as int or float: mg_canonical_number().
+   Take the arguments to the main global functions and mclass methods as a plain array (METH_FASTCALL) rather than through PyArg_ParseTuple(): mg_get_vargs().
+   - Int subscripts are formatted without creating a temporary str object, and the text for small ints is cached: mg_get_int_string().
+   Correct reference leaks in the conversion of keys and values and in the return of data through lists passed by reference.
+   - The request buffer and scratch space are released when a class method or property returns an object reference (mclass).
+   - The text of int, float and (non-contiguous) buffer keys and values is written to call-scoped scratch space rather than to temporary Python objects that were never released: MGSCRATCH.
+   - mg_set_list_item() takes over the reference to the item written (as PyList_SetItem() does), fills any gap in the list in one step and no longer adds a reference to the list itself.
+   Introduce m_global(<dbhandle>, <global>, <key> ...) returning a mglobal object for the node: node[key], node[key] = value, del node[key], key in node, iter(node) and node[start:end].
+   - The request header, global name and leading subscripts are encoded once and reused until the server's settings change: mg_global_header().
+   - "key in node" accepts the $Data result as bytes (m_set_bytes_mode) and reports a failed conversion as an error.
+   Introduce the Connection type: a DB Server connection that owns its page (MGPAGE) rather than taking one from tp_page[], with the global commands as methods, close() and use as a context manager.
+   - A Connection is accepted wherever a database handle is: mg_get_page(), mg_handle_page().
+   - Iterators, mglobal and mclass objects hold a reference to their database handle rather than its number.
+
 */
 
 /*
@@ -115,17 +165,32 @@ Version 2.4.49a 23 June 2023:
 */
 
 
-#define MG_VERSION               "2.4.49"
+#define MG_VERSION               "2.4.50"
 
 #define MG_MAX_KEY               256
 #define MG_MAX_PAGE              256
 #define MG_MAX_VARGS             32
 
+/* v2.4.50: text for the (common) small int subscripts is formatted once and kept */
+#define MG_INT_CACHE             1024
+/* v2.4.50: bytes of call-scoped scratch space for the text of keys and values (more is allocated if needed) */
+#define MG_SCRATCH_SIZE          2048
+
+/* v2.4.50: m_iterate batch sizes and the time (seconds) that an adaptive batch should take */
+#define MG_ITER_BATCH            32
+#define MG_ITER_BATCH_MAX        4096
+#define MG_ITER_BATCH_TIME       0.05
+
+/* v2.4.50: m_batch requests are sent to the DB Server in groups of (at most) this many requests or bytes */
+#define MG_BATCH_MAX             500
+#define MG_BATCH_CHUNK           32768
+
 #define MG_T_VAR                 0
 #define MG_T_STRING              1
 #define MG_T_INTEGER             2
 #define MG_T_FLOAT               3
 #define MG_T_LIST                4
+#define MG_T_BYTES               5
 
 #define MG_PRODUCT               "p"
 
@@ -165,6 +230,22 @@ Version 2.4.49a 23 June 2023:
 
 #endif
 
+/* v2.4.50: data returned from the DB Server: not decoded for handles in bytes mode */
+#define MG_MAKE_PYDATAN(p_page, a, b) mg_make_pydatan(p_page, (char *) a, b)
+
+/* v2.4.50: the hot entry points take their arguments as a plain array (METH_FASTCALL) rather than as a tuple */
+#if PY_VERSION_HEX >= 0x03070000
+#define MG_METH_FASTCALL         METH_FASTCALL
+#define MG_FASTCALL_ARGS         PyObject *const *args, Py_ssize_t nargs
+#define MG_FASTCALL_PASS         args, nargs
+#else
+#define MG_METH_FASTCALL         METH_VARARGS
+#define MG_FASTCALL_ARGS         PyObject *args
+#define MG_FASTCALL_PASS         MG_TUPLE_ARGS(args)
+#endif
+#define MG_TUPLE_ARGS(a)         &PyTuple_GET_ITEM(a, 0), PyTuple_GET_SIZE(a)
+#define MG_FASTCALL(f)           (PyCFunction) (void (*) (void)) f
+
 #define MG_ERROR(e) \
    PyErr_SetString(PyExc_RuntimeError, (char *) e); \
 
@@ -179,6 +260,24 @@ Version 2.4.49a 23 June 2023:
       return NULL; \
    } \
 
+/* v2.4.50: release the GIL while waiting on the DB Server (network connections only) */
+/* v2.4.50: the calls in progress are counted so that a page is not released from under them: mg_ppage_busy() */
+#define MG_BEGIN_ALLOW_THREADS(p_srv) \
+   { \
+      MGSRV *mg_thread_srv = (p_srv); \
+      PyThreadState *mg_thread_state = NULL; \
+      if (mg_thread_srv->mode != 2) { \
+         mg_thread_srv->in_flight ++; \
+         mg_thread_state = PyEval_SaveThread(); \
+      } \
+
+#define MG_END_ALLOW_THREADS \
+      if (mg_thread_state) { \
+         PyEval_RestoreThread(mg_thread_state); \
+         mg_thread_srv->in_flight --; \
+      } \
+   } \
+
 #define MG_FTRACE(e) \
 
 typedef struct tagMGPTYPE {
@@ -190,12 +289,26 @@ typedef struct tagMGPTYPE {
 static int le_mg_user;
 
 
+/* v2.4.50: call-scoped scratch space for the text of keys and values: see mg_get_string() */
+typedef struct tagMGSCRATCHBLK {
+   struct tagMGSCRATCHBLK *p_next;
+} MGSCRATCHBLK, *LPMGSCRATCHBLK;
+
+
+typedef struct tagMGSCRATCH {
+   int used;
+   MGSCRATCHBLK *p_next;
+   char buffer[MG_SCRATCH_SIZE];
+} MGSCRATCH, *LPMGSCRATCH;
+
+
 typedef struct tagMGVARGS {
-   int phndle;
+   PyObject *handle;                /* v2.4.50: a Connection or the number of a page */
+   struct tagMGPAGE *p_page;
    char *global;
-   PyObject *py_nkey[MG_MAX_VARGS];
    PyObject *pvars[MG_MAX_VARGS];
    MGSTR cvars[MG_MAX_VARGS];
+   MGSCRATCH scratch;
 } MGVARGS, *LPMGVARGS;
 
 
@@ -207,62 +320,199 @@ typedef struct tagMGUSER {
 typedef struct tagMGPAGE {
    MGSRV       srv;
    MGSRV *     p_srv;
+   int         bytes_mode;          /* v2.4.50: return data from the DB Server as bytes rather than str */
+   int         number_mode;         /* v2.4.50: return canonical numbers from the DB Server as int or float */
 } MGPAGE, *LPMGPAGE;
 
 
+/* v2.4.50: a connection to a DB Server that owns its page (server settings, buffers and connection pool) */
+typedef struct {
+   PyObject_HEAD
+   MGPAGE *p_page;
+   short closed;
+} MConnectionObject;
+
+
 /* v2.4.48 */
 typedef struct {
    PyObject_HEAD
    /* Type-specific fields go here. */
    PyObject *class_name; /* class name */
    int oref;
-   int phndle;
+   PyObject *handle; /* v2.4.50: database handle */
    char cname[64];
 } MClassObject;
 
 
+/* v2.4.50 */
+typedef struct {
+   PyObject_HEAD
+   PyObject *handle;
+   int direction;
+   int batch;
+   int batch_max;
+   long limit;
+   long count;
+   short busy;
+   short done;
+   short inclusive;
+   int max;
+   char *global;
+   MGSTR cvars[MG_MAX_VARGS + 1];   /* prefix subscripts followed by the current subscript */
+   MGBUF data;                      /* global name and prefix subscripts */
+   MGBUF key;                       /* current subscript */
+   MGBUF end;                       /* final subscript (if any) */
+   MGBUF items;                     /* (key, value) pairs fetched by the last batch */
+   unsigned long item_offset;
+} MIterObject;
+
+
+/* v2.4.50 */
+typedef struct {
+   PyObject_HEAD
+   PyObject *handle;
+   int direction;
+   int batch;
+   int batch_max;
+   long limit;
+   long count;
+   short busy;
+   short done;
+   short started;
+   short native;                    /* use the DB Server's own $Query (YottaDB API) */
+   int last_data;                   /* $Data of the last node returned */
+   int max;
+   int depth;
+   char *global;
+   MGSTR cvars[MG_MAX_VARGS + 1];   /* root subscripts followed by the subscripts of the current node */
+   unsigned long path_offset[MG_MAX_VARGS + 1];
+   MGBUF data;                      /* global name and root subscripts */
+   MGBUF path;                      /* subscripts of the current node below the root */
+   MGBUF items;                     /* (subscripts, value) pairs fetched by the last batch */
+   unsigned long item_offset;
+} MQueryObject;
+
+
+/* v2.4.50: a global node whose name and leading subscripts are encoded once */
+typedef struct {
+   PyObject_HEAD
+   PyObject *handle;
+   int max;
+   char *global;
+   MGSTR cvars[MG_MAX_VARGS];       /* leading subscripts */
+   MGBUF data;                      /* global name and leading subscripts */
+   MGBUF request;                   /* request header, global name and leading subscripts, encoded for the DB Server */
+   int header_len;
+   MGSRV *p_srv;                    /* the server and the settings that the request header was encoded for */
+   char server[64];
+   char uci[128];
+   int timeout;
+   int no_retry;
+   short storage_mode;
+} MGlobalObject;
+
+
 static MGPAGE gpage;
 static MGPAGE *tp_page[MG_MAX_PAGE] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+static PyTypeObject MConnectionType;
 
 static long request_no           = 0;
 static char minit[256]           = {'\0'};
 static char *mg_empty_string     = "";
+static char mg_int_cache[MG_INT_CACHE][8];
+static unsigned char mg_int_cache_len[MG_INT_CACHE];
 
 
 static void             ex_mclass_dealloc          (MClassObject *self);
 static PyObject *       ex_mclass_new              (PyTypeObject *type, PyObject *args, PyObject *kwds);
 static int              ex_mclass_init             (MClassObject *self, PyObject *args, PyObject *kwds);
-static PyObject *       ex_mclass_method           (MClassObject *self, PyObject *args);
-static PyObject *       ex_mclass_getproperty      (MClassObject *self, PyObject *args);
-static PyObject *       ex_mclass_setproperty      (MClassObject *self, PyObject *args);
+static PyObject *       ex_mclass_method           (MClassObject *self, MG_FASTCALL_ARGS);
+static PyObject *       ex_mclass_getproperty      (MClassObject *self, MG_FASTCALL_ARGS);
+static PyObject *       ex_mclass_setproperty      (MClassObject *self, MG_FASTCALL_ARGS);
 static PyObject *       ex_mclass_close            (MClassObject *self, PyObject *args);
+static void             ex_miter_dealloc           (MIterObject *self);
+static PyObject *       ex_miter_iternext          (MIterObject *self);
+static void             ex_mquery_dealloc          (MQueryObject *self);
+static PyObject *       ex_mquery_iternext         (MQueryObject *self);
+static void             ex_mglobal_dealloc         (MGlobalObject *self);
+static PyObject *       ex_mglobal_subscript       (MGlobalObject *self, PyObject *key);
+static int              ex_mglobal_ass_subscript   (MGlobalObject *self, PyObject *key, PyObject *value);
+static int              ex_mglobal_contains        (MGlobalObject *self, PyObject *key);
+static PyObject *       ex_mglobal_iter            (MGlobalObject *self);
+static PyObject *       ex_mconnection_new         (PyTypeObject *type, PyObject *args, PyObject *kwds);
+static int              ex_mconnection_init        (MConnectionObject *self, PyObject *args, PyObject *kwds);
+static void             ex_mconnection_dealloc     (MConnectionObject *self);
+static PyObject *       ex_mconnection_close       (MConnectionObject *self, PyObject *args);
+static PyObject *       ex_mconnection_enter       (MConnectionObject *self, PyObject *args);
+static PyObject *       ex_mconnection_exit        (MConnectionObject *self, PyObject *args);
 
 PyObject *              mg_make_pystringn          (char *str, int strlen);
+PyObject *              mg_make_pydatan            (MGPAGE *p_page, char *str, int strlen);
+int                     mg_canonical_number        (char *str, int strlen);
+int                     mg_canonical_double        (double real, char *buffer);
+int                     mg_receive_pystring        (MGPAGE *p_page, int chndle, MGBUF *p_buf, PyObject **output);
 int                     mg_type                    (PyObject *item);
 int                     mg_get_integer             (PyObject *item);
 double                  mg_get_float               (PyObject *item);
-char *                  mg_get_string              (PyObject *item, PyObject **item_tmp, int *size);
-int                     mg_get_keys                (PyObject *keys, MGSTR *ckeys, PyObject **keys_tmp, char *record);
-int                     mg_get_vargs               (PyObject *args, MGVARGS *pvargs, int context);
+char *                  mg_get_string              (PyObject *item, MGSCRATCH *p_scratch, int *size);
+char *                  mg_get_int_string          (long long x, MGSCRATCH *p_scratch, int *size);
+int                     mg_get_keys                (PyObject *keys, MGSTR *ckeys, MGSCRATCH *p_scratch, char *record);
+int                     mg_get_vargs               (PyObject *self, PyObject *const *args, Py_ssize_t nargs, MGVARGS *pvargs, int context);
+void                    mg_scratch_init            (MGSCRATCH *p_scratch);
+char *                  mg_scratch_alloc           (MGSCRATCH *p_scratch, int size);
+char *                  mg_scratch_copy            (MGSCRATCH *p_scratch, char *data, int size);
+int                     mg_scratch_release         (MGSCRATCH *p_scratch);
 int                     mg_set_list_item           (PyObject * list, int index, PyObject * item);
 int                     mg_kill_list               (PyObject * list);
 int                     mg_kill_list_item          (PyObject * list, int index);
 MGPAGE *                mg_ppage                   (int phndle);
 int                     mg_ppage_init              (MGPAGE * p_page);
+int                     mg_ppage_host              (MGPAGE * p_page, char *netname, int port, char *username, char *password);
+int                     mg_ppage_close             (MGPAGE * p_page);
+int                     mg_ppage_free              (MGPAGE * p_page);
+int                     mg_ppage_busy              (MGPAGE * p_page);
+int                     mg_get_page                (PyObject *handle, void *pp_page);
+int                     mg_parse_handle            (PyObject *self, PyObject *args, MGPAGE **pp_page);
+MGPAGE *                mg_handle_page             (PyObject *handle);
+MGPAGE *                mg_handle_ppage            (PyObject *handle);
+int                     mg_global_command          (MGSRV *p_srv, int chndle, MGBUF *p_buf, char *command, char *global, MGSTR *cvars, int max);
+int                     mg_global_order_data       (MGSRV *p_srv, int chndle, MGBUF *p_buf, int direction, char *global, MGSTR *cvars, int max);
+PyObject *              mg_order_data              (PyObject *self, PyObject *const *args, Py_ssize_t nargs, int direction);
+int                     mg_batch_command           (char *op);
+int                     mg_request_global          (MGSRV *p_srv, int chndle, MGBUF *p_buf, char *command, char *global, MGSTR *cvars, int max);
+int                     mg_pipeline                (MGSRV *p_srv, int chndle, MGBUF *p_requests, int count, MGBUF *p_buf, MGBUF *p_results);
+int                     mg_pipeline_result         (MGSRV *p_srv, MGBUF *p_buf, MGBUF *p_results);
+int                     mg_pipeline_get            (MGSRV *p_srv, int chndle, MGBUF *p_buf, char *global, MGSTR *cvars, int max, MGBUF *p_nodes, int count, MGBUF *p_results);
+int                     mg_pipeline_items          (MGSRV *p_srv, int chndle, MGBUF *p_buf, char *global, MGSTR *cvars, int max, MGBUF *p_nodes, int count, MGBUF *p_items, int full);
+int                     mg_node_add                (MGBUF *p_nodes, MGSTR *subs, int nsubs);
+int                     mg_node_get                (MGBUF *p_nodes, unsigned long *offset, MGSTR *subs, int nmax);
+int                     mg_item_add                (MGBUF *p_items, MGSTR *subs, int nsubs, int count, unsigned char *value, unsigned long len);
+int                     mg_batch_execute           (MGSRV *p_srv, MGBUF *p_ops, int count, MGBUF *p_buf, MGBUF *p_results);
+int                     mg_iterate_root            (MGBUF *p_data, char **global, MGSTR *cvars, char *root_global, MGSTR *root_cvars, int max);
+PyObject *              mg_iterate_new             (PyObject *handle, char *global, MGSTR *cvars, int max, int direction, int batch, PyObject *py_start, PyObject *py_end, long limit, MGSCRATCH *p_scratch);
+int                     mg_global_header           (MGlobalObject *self, MGSRV *p_srv, MGBUF *p_buf, char command);
+PyObject *              mg_global_node             (MGlobalObject *self, char command, PyObject *key, PyObject *value);
+int                     mg_iterate_fetch           (MIterObject *self, MGSRV *p_srv, MGBUF *p_buf);
+int                     mg_iterate_batch           (int *batch, int batch_max, int full, double elapsed);
+int                     mg_query_fetch             (MQueryObject *self, MGSRV *p_srv, MGBUF *p_buf);
+int                     mg_query_next              (MQueryObject *self, MGSRV *p_srv, int chndle, MGBUF *p_buf);
+int                     mg_query_set               (MQueryObject *self, int level, char *sub, unsigned long len);
+int                     mg_canonic_number          (char *p, int len);
+int                     mg_collate                 (char *a, int alen, char *b, int blen);
 
 
 static PyMemberDef mclass_members[] = {
    {"class_name", T_OBJECT_EX, offsetof(MClassObject, class_name), 0, "InterSystems Class Name"},
    {"oref", T_INT, offsetof(MClassObject, oref), 0, "InterSystems Object Reference"},
-   {"phndle", T_INT, offsetof(MClassObject, phndle), 0, "InterSystems Database Handle"},
+   {"phndle", T_OBJECT, offsetof(MClassObject, handle), 0, "InterSystems Database Handle"},
    {NULL}  /* Sentinel */
 };
 
 
 static PyMethodDef mclass_methods[] = {
-   {"method", (PyCFunction) ex_mclass_method, METH_VARARGS, "Invoke InterSystems class method"},
-   {"getproperty", (PyCFunction) ex_mclass_getproperty, METH_VARARGS, "Retrieve InterSystems class property"},
-   {"setproperty", (PyCFunction) ex_mclass_setproperty, METH_VARARGS, "Set InterSystems class property"},
+   {"method", MG_FASTCALL(ex_mclass_method), MG_METH_FASTCALL, "Invoke InterSystems class method"},
+   {"getproperty", MG_FASTCALL(ex_mclass_getproperty), MG_METH_FASTCALL, "Retrieve InterSystems class property"},
+   {"setproperty", MG_FASTCALL(ex_mclass_setproperty), MG_METH_FASTCALL, "Set InterSystems class property"},
    {"close", (PyCFunction) ex_mclass_close, METH_VARARGS, "Close InterSystems class property"},
    {NULL}  /* Sentinel */
 };
@@ -283,6 +533,60 @@ static PyTypeObject MClassType = {
 };
 
 
+/* v2.4.50 */
+static PyTypeObject MIterType = {
+   PyVarObject_HEAD_INIT(NULL, 0)
+   .tp_name = "mg_python.miterator",
+   .tp_doc = "Iterator over the subscripts of a global node",
+   .tp_basicsize = sizeof(MIterObject),
+   .tp_itemsize = 0,
+   .tp_flags = Py_TPFLAGS_DEFAULT,
+   .tp_dealloc = (destructor) ex_miter_dealloc,
+   .tp_iter = PyObject_SelfIter,
+   .tp_iternext = (iternextfunc) ex_miter_iternext,
+};
+
+
+/* v2.4.50 */
+static PyTypeObject MQueryType = {
+   PyVarObject_HEAD_INIT(NULL, 0)
+   .tp_name = "mg_python.mquery",
+   .tp_doc = "Iterator over the data nodes below a global node",
+   .tp_basicsize = sizeof(MQueryObject),
+   .tp_itemsize = 0,
+   .tp_flags = Py_TPFLAGS_DEFAULT,
+   .tp_dealloc = (destructor) ex_mquery_dealloc,
+   .tp_iter = PyObject_SelfIter,
+   .tp_iternext = (iternextfunc) ex_mquery_iternext,
+};
+
+
+/* v2.4.50 */
+static PyMappingMethods mglobal_mapping = {
+   .mp_subscript = (binaryfunc) ex_mglobal_subscript,
+   .mp_ass_subscript = (objobjargproc) ex_mglobal_ass_subscript,
+};
+
+
+static PySequenceMethods mglobal_sequence = {
+   .sq_contains = (objobjproc) ex_mglobal_contains,
+};
+
+
+static PyTypeObject MGlobalType = {
+   PyVarObject_HEAD_INIT(NULL, 0)
+   .tp_name = "mg_python.mglobal",
+   .tp_doc = "A global node: node[sub] to get, set and delete, sub in node for $Data, node[start:end] and iter(node) to traverse",
+   .tp_basicsize = sizeof(MGlobalObject),
+   .tp_itemsize = 0,
+   .tp_flags = Py_TPFLAGS_DEFAULT,
+   .tp_dealloc = (destructor) ex_mglobal_dealloc,
+   .tp_as_mapping = &mglobal_mapping,
+   .tp_as_sequence = &mglobal_sequence,
+   .tp_iter = (getiterfunc) ex_mglobal_iter,
+};
+
+
 
 PyObject * mg_make_pystringn(char *str, int strlen)
 {
@@ -309,6 +613,242 @@ PyObject * mg_make_pystringn(char *str, int strlen)
 }
 
 
+/* v2.4.50 */
+PyObject * mg_make_pydatan(MGPAGE *p_page, char *str, int strlen)
+{
+   int number;
+   char buffer[64];
+
+   if (p_page && p_page->number_mode && strlen > 0 && strlen < 64 && (number = mg_canonical_number(str, strlen))) {
+      strncpy(buffer, str, strlen);
+      buffer[strlen] = '\0';
+      if (number == 1) {
+         return PyLong_FromString(buffer, NULL, 10);
+      }
+      return PyFloat_FromDouble(strtod(buffer, NULL));
+   }
+
+   if (p_page && p_page->bytes_mode) {
+#if PY_MAJOR_VERSION >= 3
+      return PyBytes_FromStringAndSize(strlen > 0 ? str : "", strlen > 0 ? strlen : 0);
+#else
+      return PyString_FromStringAndSize(strlen > 0 ? str : "", strlen > 0 ? strlen : 0);
+#endif
+   }
+
+   return mg_make_pystringn(str, strlen);
+}
+
+
+/* v2.4.50: is the string a number in canonical M form: 1 for an integer, 2 for a decimal, otherwise 0 */
+int mg_canonical_number(char *str, int strlen)
+{
+   int n, start, dot;
+
+   start = (strlen > 1 && str[0] == '-') ? 1 : 0;
+   dot = -1;
+   for (n = start; n < strlen; n ++) {
+      if (str[n] == '.' && dot < 0) {
+         dot = n;
+      }
+      else if (str[n] < '0' || str[n] > '9') {
+         return 0;
+      }
+   }
+
+   if (dot < 0) {
+      /* No leading zeros, and zero is unsigned */
+      if (str[start] == '0' && (strlen > 1)) {
+         return 0;
+      }
+      return 1;
+   }
+   /* A fractional part without trailing zeros, and no leading zeros (.5 rather than 0.5) */
+   if (dot == (strlen - 1) || str[strlen - 1] == '0' || (dot > start && str[start] == '0')) {
+      return 0;
+   }
+   return 2;
+}
+
+
+/* v2.4.50: format a double as a canonical M number, using the shortest digits that read back as the same double */
+/*          buffer must have room for 330 characters (the smallest subnormal number has 324 decimal places) */
+int mg_canonical_double(double real, char *buffer)
+{
+   int n, len, nd, point;
+   char *repr, *p;
+   char digits[32];
+
+   if (real == 0) {
+      strcpy(buffer, "0");
+      return 1;
+   }
+
+   repr = PyOS_double_to_string(real, 'r', 0, 0, NULL);
+   if (!repr) {
+      PyErr_Clear();
+      sprintf(buffer, "%.17g", real);
+      return (int) strlen(buffer);
+   }
+
+   /* NaN and infinity have no M equivalent: pass them on as they are */
+   if (!(real == real) || (real - real) != 0) {
+      strcpy(buffer, repr);
+      PyMem_Free(repr);
+      return (int) strlen(buffer);
+   }
+
+   /* Collect the digits of the mantissa and the position of the decimal point, allowing for any exponent */
+   nd = 0;
+   point = -1;
+   for (p = (*repr == '-') ? repr + 1 : repr; *p && *p != 'e' && *p != 'E' && nd < 30; p ++) {
+      if (*p == '.')
+         point = nd;
+      else
+         digits[nd ++] = *p;
+   }
+   if (point < 0) {
+      point = nd;
+   }
+   if (*p == 'e' || *p == 'E') {
+      point += (int) strtol(p + 1, NULL, 10);
+   }
+   PyMem_Free(repr);
+
+   while (nd > 0 && digits[0] == '0') {
+      memmove((void *) digits, (void *) (digits + 1), nd - 1);
+      nd --;
+      point --;
+   }
+   while (nd > 0 && digits[nd - 1] == '0') {
+      nd --;
+   }
+
+   len = 0;
+   if (real < 0) {
+      buffer[len ++] = '-';
+   }
+   if (point <= 0) {
+      buffer[len ++] = '.';
+      for (n = point; n < 0; n ++) {
+         buffer[len ++] = '0';
+      }
+      for (n = 0; n < nd; n ++) {
+         buffer[len ++] = digits[n];
+      }
+   }
+   else if (point >= nd) {
+      for (n = 0; n < nd; n ++) {
+         buffer[len ++] = digits[n];
+      }
+      for (n = nd; n < point; n ++) {
+         buffer[len ++] = '0';
+      }
+   }
+   else {
+      for (n = 0; n < nd; n ++) {
+         if (n == point) {
+            buffer[len ++] = '.';
+         }
+         buffer[len ++] = digits[n];
+      }
+   }
+   buffer[len] = '\0';
+
+   return len;
+}
+
+
+/* v2.4.50: complete a response left partly unread by mg_db_receive() (mode 2) */
+/*          the rest of a large value is received straight into the Python string (or bytes) returned in output rather than into p_buf and then copied */
+/*          returns 0 if the whole response is (now) in p_buf instead */
+int mg_receive_pystring(MGPAGE *p_page, int chndle, MGBUF *p_buf, PyObject **output)
+{
+   int n;
+   unsigned long ssize, i, word, mask;
+   unsigned char *data;
+   MGSRV *p_srv;
+   PyObject *py;
+
+   *output = NULL;
+   p_srv = p_page->p_srv;
+
+   if (p_srv->mode == 2 || p_buf->data_size < MG_RECV_HEAD) {
+      return 0;
+   }
+   ssize = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
+   if ((p_buf->data_size - MG_RECV_HEAD) >= ssize) {
+      return 0;
+   }
+
+   py = NULL;
+   data = NULL;
+   if (!mg_get_error(p_srv, (char *) p_buf->p_buffer)) {
+#if PY_MAJOR_VERSION >= 3
+      if (p_page->bytes_mode) {
+         py = PyBytes_FromStringAndSize(NULL, (Py_ssize_t) ssize);
+         if (py) {
+            data = (unsigned char *) PyBytes_AS_STRING(py);
+         }
+      }
+      else {
+         /* Assume ASCII: the commonest case and the only one where the data can be used as it arrives */
+         py = PyUnicode_New((Py_ssize_t) ssize, 127);
+         if (py) {
+            data = (unsigned char *) PyUnicode_1BYTE_DATA(py);
+         }
+      }
+#else
+      py = PyString_FromStringAndSize(NULL, (Py_ssize_t) ssize);
+      if (py) {
+         data = (unsigned char *) PyString_AS_STRING(py);
+      }
+#endif
+      if (!py) {
+         PyErr_Clear();
+      }
+   }
+
+   MG_BEGIN_ALLOW_THREADS(p_srv);
+   n = mg_db_receive_rest(p_srv, chndle, p_buf, data);
+   MG_END_ALLOW_THREADS;
+
+   if (!py) {
+      return 0;
+   }
+   if (!n) {
+      Py_DECREF(py);
+      MG_ERROR(p_srv->pcon[chndle]->error);
+      return 1;
+   }
+
+#if PY_MAJOR_VERSION >= 3
+   if (p_page->bytes_mode) {
+      *output = py;
+      return 1;
+   }
+
+   /* Check a word at a time that the data is ASCII: otherwise decode it (as UTF-8) into a new string */
+   mask = 0;
+   for (i = 0; (i + sizeof(word)) <= ssize; i += sizeof(word)) {
+      memcpy((void *) &word, (void *) (data + i), sizeof(word));
+      mask |= word;
+   }
+   for (; i < ssize; i ++) {
+      mask |= data[i];
+   }
+   if (mask & (((unsigned long) -1 / 255) * 128)) {
+      *output = PyUnicode_FromStringAndSize((char *) data, (Py_ssize_t) ssize);
+      Py_DECREF(py);
+      return 1;
+   }
+#endif
+
+   *output = py;
+   return 1;
+}
+
+
 static PyObject * ex_m_ext_version(PyObject *self, PyObject *args)
 {
    char buffer[256];
@@ -350,7 +890,11 @@ static PyObject * ex_m_release_page_handle(PyObject *self, PyObject *args)
       return NULL;
 
    if (phndle > 0 && phndle < MG_MAX_PAGE && tp_page[phndle]) {
-      mg_free((void *) tp_page[phndle], 0);
+      if (mg_ppage_busy(tp_page[phndle])) { /* v2.4.50 */
+         MG_ERROR("mg_python: The server handle is in use by another thread");
+         return NULL;
+      }
+      mg_ppage_free(tp_page[phndle]); /* v2.4.50 */
       tp_page[phndle] = NULL;
       result = 1;
    }
@@ -361,14 +905,13 @@ static PyObject * ex_m_release_page_handle(PyObject *self, PyObject *args)
 
 static PyObject * ex_m_set_storage_mode(PyObject *self, PyObject *args)
 {
-   int result, phndle, smode;
+   int result, smode;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "ii", &phndle, &smode))
+   if (!PyArg_ParseTuple(args, "O&i", mg_get_page, &p_page, &smode))
       return NULL;
 
    result = 0;
-   p_page = mg_ppage(phndle);
 
    if (p_page) {
       p_page->p_srv->storage_mode = smode;
@@ -381,7 +924,7 @@ static PyObject * ex_m_set_storage_mode(PyObject *self, PyObject *args)
 
 static PyObject * ex_m_set_host(PyObject *self, PyObject *args)
 {
-   int result, phndle, port;
+   int result, port;
    char *netname, *username, *password;
    MGPAGE *p_page;
 
@@ -389,24 +932,13 @@ static PyObject * ex_m_set_host(PyObject *self, PyObject *args)
    username = NULL;
    password = NULL;
 
-   if (!PyArg_ParseTuple(args, "isiss", &phndle, &netname, &port, &username, &password))
+   if (!PyArg_ParseTuple(args, "O&siss", mg_get_page, &p_page, &netname, &port, &username, &password))
       return NULL;
 
    result = 0;
 
-   p_page = mg_ppage(phndle);
-
    if (p_page) {
-      strcpy(p_page->p_srv->ip_address, netname);
-      p_page->p_srv->port = port;
-      if (username) {
-         strcpy(p_page->p_srv->username, username);
-      }
-      if (password) {
-         strcpy(p_page->p_srv->password, password);
-      }
-      p_page->p_srv->mode = 1;
-      result = 1;
+      result = mg_ppage_host(p_page, netname, port, username, password); /* v2.4.50 */
    }
 
    return Py_BuildValue("i", result);
@@ -415,17 +947,15 @@ static PyObject * ex_m_set_host(PyObject *self, PyObject *args)
 
 static PyObject * ex_m_set_uci(PyObject *self, PyObject *args)
 {
-   int result, phndle;
+   int result;
    char *uci;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "is", &phndle, &uci))
+   if (!PyArg_ParseTuple(args, "O&s", mg_get_page, &p_page, &uci))
       return NULL;
 
    result = 0;
 
-   p_page = mg_ppage(phndle);
-
    if (p_page) {
       strcpy(p_page->p_srv->uci, uci);
       result = 1;
@@ -437,17 +967,15 @@ static PyObject * ex_m_set_uci(PyObject *self, PyObject *args)
 
 static PyObject * ex_m_set_server(PyObject *self, PyObject *args)
 {
-   int result, phndle;
+   int result;
    char *server;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "is", &phndle, &server))
+   if (!PyArg_ParseTuple(args, "O&s", mg_get_page, &p_page, &server))
       return NULL;
 
    result = 0;
 
-   p_page = mg_ppage(phndle);
-
    if (p_page) {
       strcpy(p_page->p_srv->server, server);
       result = 1;
@@ -460,16 +988,14 @@ static PyObject * ex_m_set_server(PyObject *self, PyObject *args)
 /* v2.3.46 */
 static PyObject * ex_m_set_timeout(PyObject *self, PyObject *args)
 {
-   int result, phndle, timeout;
+   int result, timeout;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "ii", &phndle, &timeout))
+   if (!PyArg_ParseTuple(args, "O&i", mg_get_page, &p_page, &timeout))
       return NULL;
 
    result = 0;
 
-   p_page = mg_ppage(phndle);
-
    if (p_page && timeout >= 0) {
       p_page->p_srv->timeout = timeout;
       result = 1;
@@ -479,140 +1005,312 @@ static PyObject * ex_m_set_timeout(PyObject *self, PyObject *args)
 }
 
 
-static PyObject * ex_m_bind_server_api(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_set_buffer_policy(PyObject *self, PyObject *args)
 {
-   int result, phndle;
-   char *dbtype_name, *path, *username, *password, *env, *params;
+   int result, high_water, max_buffers;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "issssss", &phndle, &dbtype_name, &path, &username, &password, &env, &params))
+   if (!PyArg_ParseTuple(args, "O&ii", mg_get_page, &p_page, &high_water, &max_buffers))
       return NULL;
 
    result = 0;
-   p_page = mg_ppage(phndle);
-
-   strcpy(p_page->p_srv->dbtype_name, dbtype_name);
-   strcpy(p_page->p_srv->shdir, path);
-   strcpy(p_page->p_srv->username, password);
-   strcpy(p_page->p_srv->password, password);
-
-   p_page->p_srv->p_env = (MGBUF *) mg_malloc(sizeof(MGBUF), 0);
-   mg_buf_init(p_page->p_srv->p_env, MG_BUFSIZE, MG_BUFSIZE);
-   mg_buf_cpy(p_page->p_srv->p_env, env, (int) strlen(env));
 
-   result = mg_bind_server_api(p_page->p_srv, 0);
-
-   if (!result) {
-      if (!strlen(p_page->p_srv->error_mess)) {
-         strcpy(p_page->p_srv->error_mess, "The server API is not available on this host");
-      }
-      MG_ERROR(p_page->p_srv->error_mess);
-      return NULL;
+   if (p_page && high_water >= MG_BUFSIZE && max_buffers >= 0 && max_buffers <= MG_BUF_CACHE) {
+      p_page->p_srv->buf_high_water = high_water;
+      p_page->p_srv->buf_cache_max = max_buffers;
+      mg_buf_cache_free(p_page->p_srv, max_buffers);
+      result = 1;
    }
 
    return Py_BuildValue("i", result);
-
 }
 
 
-static PyObject * ex_m_release_server_api(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_set_connection_pool(PyObject *self, PyObject *args)
 {
-   int result, phndle;
+   int result, min, max, wait, idle, n;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "i", &phndle))
+   wait = MG_POOL_WAIT;
+   idle = 0;
+   if (!PyArg_ParseTuple(args, "O&ii|ii", mg_get_page, &p_page, &min, &max, &wait, &idle))
       return NULL;
 
    result = 0;
-   p_page = mg_ppage(phndle);
 
-   result = mg_release_server_api(p_page->p_srv, 0);
+   if (p_page && min >= 0 && max > 0 && min <= max && max <= MG_MAXCON && wait >= 0 && idle >= 0) {
+      mg_enter_critical_section((void *) &dbx_global_mutex);
+      p_page->p_srv->pool_min = min;
+      p_page->p_srv->pool_max = max;
+      p_page->p_srv->pool_wait = wait;
+      p_page->p_srv->pool_idle = idle;
+      for (n = 0; n < p_page->p_srv->pool_waiting; n ++) {
+         mg_pool_signal(p_page->p_srv);
+      }
+      mg_leave_critical_section((void *) &dbx_global_mutex);
+      result = 1;
+   }
 
    return Py_BuildValue("i", result);
 }
 
 
-static PyObject * ex_m_get_last_error(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_pool_warm(PyObject *self, PyObject *args)
 {
-   int result, phndle;
-   char *error;
+   int result, count;
+   char *global;
    MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "i", &phndle))
+   global = NULL;
+   if (!PyArg_ParseTuple(args, "O&i|s", mg_get_page, &p_page, &count, &global))
       return NULL;
 
-   error = "";
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      return NULL;
+   }
 
-   p_page = mg_ppage(phndle);
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   result = mg_pool_warm(p_page->p_srv, count, global);
+   MG_END_ALLOW_THREADS;
 
-   if (p_page) {
-      error = p_page->p_srv->error_mess;
-      result = 1;
+   if (result < 0) {
+      MG_ERROR("mg_python: m_pool_warm: Insufficient memory");
+      return NULL;
    }
 
-   return Py_BuildValue("s", error);
+   return Py_BuildValue("i", result);
 }
 
 
-static PyObject * ex_m_set(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_set_health_check(PyObject *self, PyObject *args)
 {
-   MGBUF mgbuf, *p_buf;
-   int n, max;
-   int ifc[4];
-   int chndle;
+   int result, interval, timeout;
    MGPAGE *p_page;
-   MGVARGS vargs;
-   PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   timeout = MG_HEALTH_TIMEOUT;
+   if (!PyArg_ParseTuple(args, "O&i|i", mg_get_page, &p_page, &interval, &timeout))
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   result = 0;
 
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   if (p_page && p_page->p_srv->mode != 2 && interval >= 0 && timeout > 0) {
+      result = mg_health_start(p_page->p_srv, interval, timeout);
+   }
 
-   MG_FTRACE("m_set");
+   return Py_BuildValue("i", result);
+}
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
 
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
-      return NULL;
-   }
+/* v2.4.50 */
+static PyObject * ex_m_set_receive_spin(PyObject *self, PyObject *args)
+{
+   int result, usecs;
+   MGPAGE *p_page;
 
-   mg_request_header(p_page->p_srv, p_buf, "S", MG_PRODUCT);
+   if (!PyArg_ParseTuple(args, "O&i", mg_get_page, &p_page, &usecs))
+      return NULL;
 
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   result = 0;
 
-   for (n = 0; n < max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+   if (p_page && usecs >= 0 && usecs <= MG_SPIN_MAX) {
+      p_page->p_srv->spin_max = usecs;
+      result = 1;
    }
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+   return Py_BuildValue("i", result);
+}
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+/* v2.4.50: return data from the DB Server as bytes (mode 1) or as str decoded from UTF-8 (mode 0) */
+static PyObject * ex_m_set_bytes_mode(PyObject *self, PyObject *args)
+{
+   int result, mode;
+   MGPAGE *p_page;
 
-   MG_MEMCHECK("Insufficient memory to process response", 0);
+   if (!PyArg_ParseTuple(args, "O&i", mg_get_page, &p_page, &mode))
+      return NULL;
 
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
+   result = 0;
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
-      return NULL;
+   if (p_page) {
+      p_page->bytes_mode = mode ? 1 : 0;
+      result = 1;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   return Py_BuildValue("i", result);
+}
 
-   mg_buf_free(p_buf);
+
+/* v2.4.50: return canonical numbers from the DB Server as int or float (mode 1) or as str (mode 0) */
+static PyObject * ex_m_set_number_mode(PyObject *self, PyObject *args)
+{
+   int result, mode;
+   MGPAGE *p_page;
+
+   if (!PyArg_ParseTuple(args, "O&i", mg_get_page, &p_page, &mode))
+      return NULL;
+
+   result = 0;
+
+   if (p_page) {
+      p_page->number_mode = mode ? 1 : 0;
+      result = 1;
+   }
+
+   return Py_BuildValue("i", result);
+}
+
+
+static PyObject * ex_m_bind_server_api(PyObject *self, PyObject *args)
+{
+   int result;
+   char *dbtype_name, *path, *username, *password, *env, *params;
+   MGPAGE *p_page;
+
+   if (!PyArg_ParseTuple(args, "O&ssssss", mg_get_page, &p_page, &dbtype_name, &path, &username, &password, &env, &params))
+      return NULL;
+
+   result = 0;
+
+   strcpy(p_page->p_srv->dbtype_name, dbtype_name);
+   strcpy(p_page->p_srv->shdir, path);
+   strcpy(p_page->p_srv->username, password);
+   strcpy(p_page->p_srv->password, password);
+
+   p_page->p_srv->p_env = (MGBUF *) mg_malloc(sizeof(MGBUF), 0);
+   mg_buf_init(p_page->p_srv->p_env, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_cpy(p_page->p_srv->p_env, env, (int) strlen(env));
+
+   result = mg_bind_server_api(p_page->p_srv, 0);
+
+   if (!result) {
+      if (!strlen(p_page->p_srv->error_mess)) {
+         strcpy(p_page->p_srv->error_mess, "The server API is not available on this host");
+      }
+      MG_ERROR(p_page->p_srv->error_mess);
+      return NULL;
+   }
+
+   return Py_BuildValue("i", result);
+
+}
+
+
+static PyObject * ex_m_release_server_api(PyObject *self, PyObject *args)
+{
+   int result;
+   MGPAGE *p_page;
+
+   if (!PyArg_ParseTuple(args, "O&", mg_get_page, &p_page))
+      return NULL;
+
+   result = 0;
+
+   result = mg_release_server_api(p_page->p_srv, 0);
+
+   return Py_BuildValue("i", result);
+}
+
+
+static PyObject * ex_m_get_last_error(PyObject *self, PyObject *args)
+{
+   int result;
+   char *error;
+   MGPAGE *p_page;
+
+   if (!PyArg_ParseTuple(args, "O&", mg_get_page, &p_page))
+      return NULL;
+
+   error = "";
+
+   if (p_page) {
+      error = p_page->p_srv->error_mess;
+      result = 1;
+   }
+
+   return Py_BuildValue("s", error);
+}
+
+
+static PyObject * ex_m_set(PyObject *self, MG_FASTCALL_ARGS)
+{
+   MGBUF mgbuf, *p_buf;
+   int n, max;
+   int ifc[4];
+   int chndle;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   MGIOV iov;
+   PyObject *output;
+
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
+      return NULL;
+
+   p_page = vargs.p_page;
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+
+   MG_FTRACE("m_set");
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'S', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      /* v2.4.50: large values are sent straight from the Python object rather than copied into the request buffer */
+      p_buf->p_iov = &iov;
+      mg_request_header(p_page->p_srv, p_buf, "S", MG_PRODUCT);
+
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
+
+      MG_MEMCHECK("Insufficient memory to process request", 1);
+
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
+
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
 
    return output;
 }
@@ -625,15 +1323,15 @@ static PyObject * ex_ma_set(PyObject *self, PyObject *args)
    int ifc[4];
    char *global, *data;
    MGSTR nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
    PyObject *py_data;
-   PyObject *p;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
+   MGIOV iov;
 
-   if (!PyArg_ParseTuple(args, "isOO", &phndle, &global, &key, &py_data))
+   if (!PyArg_ParseTuple(args, "O&sOO", mg_get_page, &p_page, &global, &key, &py_data))
       return NULL;
 
    if (mg_type(key) != MG_T_LIST) {
@@ -641,24 +1339,27 @@ static PyObject * ex_ma_set(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_set");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
+   p_buf->p_iov = &iov; /* v2.4.50: send large values without copying them */
    mg_request_header(p_page->p_srv, p_buf, "S", MG_PRODUCT);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
-   data = mg_get_string(py_data, &p, &data_len);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
+   data = mg_get_string(py_data, &scratch, &data_len);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -675,9 +1376,11 @@ static PyObject * ex_ma_set(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -685,17 +1388,19 @@ static PyObject * ex_ma_set(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_get(PyObject *self, PyObject *args)
+static PyObject * ex_m_get(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -705,40 +1410,57 @@ static PyObject * ex_m_get(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("m_get");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "G", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'G', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "G", MG_PRODUCT);
 
-   for (n = 0; n < max; n ++) {
       ifc[0] = 0;
       ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 2);
+      MG_END_ALLOW_THREADS;
+
+      if (mg_receive_pystring(p_page, chndle, p_buf, &output)) { /* v2.4.50 */
+         mg_db_disconnect(p_page->p_srv, chndle, 1);
+         mg_scratch_release(&vargs.scratch);
+         mg_buf_release(p_page->p_srv, p_buf);
+         return output;
+      }
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -746,12 +1468,14 @@ static PyObject * ex_m_get(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -763,13 +1487,13 @@ static PyObject * ex_ma_get(PyObject *self, PyObject *args)
    char *global;
    int ifc[4];
    MGSTR nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isO", &phndle, &global, &key)) {
+   if (!PyArg_ParseTuple(args, "O&sO", mg_get_page, &p_page, &global, &key)) {
       return NULL;
    }
 
@@ -778,22 +1502,24 @@ static PyObject * ex_ma_get(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_get");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    mg_request_header(p_page->p_srv, p_buf, "G", MG_PRODUCT);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -807,9 +1533,18 @@ static PyObject * ex_ma_get(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 2);
+   MG_END_ALLOW_THREADS;
+
+   if (mg_receive_pystring(p_page, chndle, p_buf, &output)) { /* v2.4.50 */
+      mg_db_disconnect(p_page->p_srv, chndle, 1);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return output;
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -818,18 +1553,20 @@ static PyObject * ex_ma_get(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 
 }
 
 
-static PyObject * ex_m_kill(PyObject *self, PyObject *args)
+static PyObject * ex_m_kill(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -839,40 +1576,50 @@ static PyObject * ex_m_kill(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("m_kill");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "K", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'K', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "K", MG_PRODUCT);
 
-   for (n = 0; n < max; n ++) {
       ifc[0] = 0;
       ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -880,12 +1627,14 @@ static PyObject * ex_m_kill(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -897,13 +1646,13 @@ static PyObject * ex_ma_kill(PyObject *self, PyObject *args)
    char *global;
    int ifc[4];
    MGSTR nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isO", &phndle, &global, &key))
+   if (!PyArg_ParseTuple(args, "O&sO", mg_get_page, &p_page, &global, &key))
       return NULL;
 
    if (mg_type(key) != MG_T_LIST) {
@@ -911,23 +1660,25 @@ static PyObject * ex_ma_kill(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_kill");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    mg_request_header(p_page->p_srv, p_buf, "K", MG_PRODUCT);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -941,9 +1692,11 @@ static PyObject * ex_ma_kill(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -951,17 +1704,19 @@ static PyObject * ex_ma_kill(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_data(PyObject *self, PyObject *args)
+static PyObject * ex_m_data(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -971,40 +1726,50 @@ static PyObject * ex_m_data(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("m_data");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "D", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'D', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "D", MG_PRODUCT);
 
-   for (n = 0; n < max; n ++) {
       ifc[0] = 0;
       ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1012,12 +1777,14 @@ static PyObject * ex_m_data(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -1028,13 +1795,13 @@ static PyObject * ex_ma_data(PyObject *self, PyObject *args)
    char *global;
    int ifc[4];
    MGSTR  nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isO", &phndle, &global, &key))
+   if (!PyArg_ParseTuple(args, "O&sO", mg_get_page, &p_page, &global, &key))
       return NULL;
 
    if (mg_type(key) != MG_T_LIST) {
@@ -1042,23 +1809,25 @@ static PyObject * ex_ma_data(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_data");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    mg_request_header(p_page->p_srv, p_buf, "D", MG_PRODUCT);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -1072,9 +1841,11 @@ static PyObject * ex_ma_data(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1082,17 +1853,19 @@ static PyObject * ex_ma_data(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_order(PyObject *self, PyObject *args)
+static PyObject * ex_m_order(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -1102,40 +1875,50 @@ static PyObject * ex_m_order(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("m_order");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "O", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'O', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "O", MG_PRODUCT);
 
-   for (n = 0; n < max; n ++) {
       ifc[0] = 0;
       ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1143,12 +1926,14 @@ static PyObject * ex_m_order(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -1160,13 +1945,13 @@ static PyObject * ex_ma_order(PyObject *self, PyObject *args)
    char *global = NULL;
    int ifc[4];
    MGSTR nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isO", &phndle, &global, &key))
+   if (!PyArg_ParseTuple(args, "O&sO", mg_get_page, &p_page, &global, &key))
       return NULL;
 
    if (mg_type(key) != MG_T_LIST) {
@@ -1174,23 +1959,25 @@ static PyObject * ex_ma_order(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_order");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    mg_request_header(p_page->p_srv, p_buf, "O", MG_PRODUCT);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -1204,9 +1991,11 @@ static PyObject * ex_ma_order(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1214,21 +2003,24 @@ static PyObject * ex_ma_order(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    /* output = PyBytes_FromStringAndSize(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD); */
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   Py_INCREF(output);
    mg_set_list_item(key, max, output);
 
-   mg_buf_free(p_buf);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_previous(PyObject *self, PyObject *args)
+static PyObject * ex_m_previous(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -1238,40 +2030,50 @@ static PyObject * ex_m_previous(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("m_previous");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "P", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'P', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "P", MG_PRODUCT);
 
-   for (n = 0; n < max; n ++) {
       ifc[0] = 0;
       ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1279,12 +2081,14 @@ static PyObject * ex_m_previous(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -1296,13 +2100,13 @@ static PyObject * ex_ma_previous(PyObject *self, PyObject *args)
    char *global = NULL;
    int ifc[4];
    MGSTR nkey[MG_MAX_KEY];
-   int chndle, phndle;
+   int chndle;
    MGPAGE *p_page;
    PyObject *key;
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isO", &phndle, &global, &key))
+   if (!PyArg_ParseTuple(args, "O&sO", mg_get_page, &p_page, &global, &key))
       return NULL;
 
    if (mg_type(key) != MG_T_LIST) {
@@ -1310,23 +2114,25 @@ static PyObject * ex_ma_previous(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_previous");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
    mg_request_header(p_page->p_srv, p_buf, "P", MG_PRODUCT);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -1340,9 +2146,11 @@ static PyObject * ex_ma_previous(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -1350,800 +2158,1336 @@ static PyObject * ex_ma_previous(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   Py_INCREF(output);
    mg_set_list_item(key, max, output);
 
-   mg_buf_free(p_buf);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 /* v2.3.46 */
-static PyObject * ex_m_increment(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_order_data(PyObject *self, MG_FASTCALL_ARGS)
 {
-   MGBUF mgbuf, *p_buf;
-   int n, max;
-   int ifc[4];
-   int chndle;
+   return mg_order_data(self, MG_FASTCALL_PASS, 1);
+}
+
+
+/* v2.4.50 */
+static PyObject * ex_m_previous_data(PyObject *self, MG_FASTCALL_ARGS)
+{
+   return mg_order_data(self, MG_FASTCALL_PASS, -1);
+}
+
+
+/* v2.4.50 */
+static PyObject * ex_m_batch(PyObject *self, PyObject *args)
+{
+   int rc, n, count, command, len;
+   unsigned long offset;
+   unsigned char size[4];
+   char *p;
+   PyObject *ops, *seq, *op, *item, *output;
+   MGBUF mgbuf, *p_buf, request, results;
+   MGSCRATCH scratch;
    MGPAGE *p_page;
-   MGVARGS vargs;
-   PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   p_page = NULL;
+   if (Py_TYPE(self) == &MConnectionType) { /* v2.4.50: Connection.batch() */
+      if (!PyArg_ParseTuple(args, "O", &ops) || !(p_page = mg_handle_page(self)))
+         return NULL;
+   }
+   else if (!PyArg_ParseTuple(args, "O&O", mg_get_page, &p_page, &ops))
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      return NULL;
+   }
 
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   seq = PySequence_Fast(ops, "mg_python: m_batch: a list of operations is required");
+   if (!seq)
+      return NULL;
+   count = (int) PySequence_Fast_GET_SIZE(seq);
 
-   MG_FTRACE("m_increment");
+   mg_buf_init(&request, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_init(&results, MG_BUFSIZE, MG_BUFSIZE);
+   mg_scratch_init(&scratch);
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+   /* Each operation is packed as: <command> <number of arguments> (<length> <argument>) ... with the (terminated) global name first */
+   rc = 1;
+   for (n = 0; rc == 1 && n < count; n ++) {
+      op = PySequence_Fast_GET_ITEM(seq, n);
+      if (!PyTuple_Check(op) || PyTuple_Size(op) < 2 || PyTuple_Size(op) > (MG_MAX_VARGS + 2)) {
+         PyErr_Format(PyExc_RuntimeError, "mg_python: m_batch: operation %d must be a tuple of (operation, global, ...)", n);
+         rc = 0;
+         break;
+      }
+      p = mg_get_string(PyTuple_GET_ITEM(op, 0), &scratch, &len);
+      command = mg_batch_command(p);
+      if (!command) {
+         PyErr_Format(PyExc_RuntimeError, "mg_python: m_batch: operation %d: unknown operation", n);
+         rc = 0;
+         break;
+      }
+      size[0] = (unsigned char) command;
+      rc = mg_buf_cat(&request, (char *) size, 1);
+      mg_set_size(size, (unsigned long) (PyTuple_Size(op) - 1));
+      if (rc) {
+         rc = mg_buf_cat(&request, (char *) size, 4);
+      }
+      for (offset = 1; rc && offset < (unsigned long) PyTuple_Size(op); offset ++) {
+         item = PyTuple_GET_ITEM(op, offset);
+         p = mg_get_string(item, &scratch, &len);
+         mg_set_size(size, (unsigned long) len);
+         rc = mg_buf_cat(&request, (char *) size, 4);
+         if (rc && len) {
+            rc = mg_buf_cat(&request, p, len);
+         }
+         if (rc && offset == 1) {
+            rc = mg_buf_cat(&request, "\0", 1);
+         }
+         mg_scratch_release(&scratch);
+      }
+      if (!rc) {
+         MG_ERROR("Insufficient memory to process request");
+         break;
+      }
+      rc = 1;
+   }
+   mg_scratch_release(&scratch);
+   Py_DECREF(seq);
+
+   if (rc != 1) {
+      mg_buf_free(&request);
+      mg_buf_free(&results);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "I", MG_PRODUCT);
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   MG_FTRACE("m_batch");
 
-   for (n = 0; n < max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   rc = mg_batch_execute(p_page->p_srv, &request, count, p_buf, &results);
+   MG_END_ALLOW_THREADS;
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
-   MG_MEMCHECK("Insufficient memory to process response", 0);
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
+   mg_buf_free(&request);
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+   if (rc < 0) {
+      MG_ERROR("Insufficient memory to process response");
+   }
+   else if (rc == 0) {
+      if (p_buf->data_size > MG_RECV_HEAD) {
+         MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      }
+      else {
+         MG_ERROR(p_page->p_srv->error_mess);
+      }
+   }
+   mg_buf_release(p_page->p_srv, p_buf);
+   if (rc != 1) {
+      mg_buf_free(&results);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   /* Each result is packed as: <'v' or 'e'> <length> <data> */
+   output = PyList_New(count);
+   offset = 0;
+   for (n = 0; output && n < count; n ++) {
+      command = results.p_buffer[offset];
+      len = (int) mg_get_size(results.p_buffer + offset + 1);
+      p = (char *) results.p_buffer + offset + 5;
+      offset += (5 + len);
+      if (command == 'e') {
+         PyErr_Format(PyExc_RuntimeError, "mg_python: m_batch: operation %d: %.*s", n, len, p);
+         Py_DECREF(output);
+         output = NULL;
+         break;
+      }
+      item = MG_MAKE_PYDATAN(p_page, p, len);
+      if (!item) {
+         Py_DECREF(output);
+         output = NULL;
+         break;
+      }
+      PyList_SET_ITEM(output, n, item);
+   }
+   mg_buf_free(&results);
+
    return output;
 }
 
 
-static PyObject * ex_m_tstart(PyObject *self, PyObject *args)
+/* v2.4.50: encode a request for sending to the DB Server by the application's own (for example, asyncio-based) network code */
+static PyObject * ex_m_request(PyObject *self, PyObject *args)
 {
-   MGBUF mgbuf, *p_buf;
-   int n;
-   int chndle;
+   int n, max, len;
+   char command[2];
+   char *op, *name;
+   PyObject *head, *output;
+   MGSTR cvars[MG_MAX_VARGS];
+   MGBUF request;
+   MGSCRATCH scratch;
    MGPAGE *p_page;
-   MGVARGS vargs;
-   PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "i", &(vargs.phndle))) {
+   max = (int) PyTuple_Size(args) - 3;
+   if (max < 0 || max > MG_MAX_VARGS) {
+      MG_ERROR("mg_python: m_request: usage: m_request(<dbhandle>, <operation>, <global or function>, ...)");
       return NULL;
    }
+   head = PyTuple_GetSlice(args, 0, 3);
+   if (!head)
+      return NULL;
+   p_page = NULL;
+   n = PyArg_ParseTuple(head, "O&ss", mg_get_page, &p_page, &op, &name);
+   Py_DECREF(head);
+   if (!n)
+      return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
-
-   MG_FTRACE("m_tstart");
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      return NULL;
+   }
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+   if (!strcmp(op, "function") || !strcmp(op, "X")) {
+      command[0] = 'X';
+   }
+   else {
+      command[0] = (char) mg_batch_command(op);
+   }
+   command[1] = '\0';
+   if (!command[0]) {
+      MG_ERROR("mg_python: m_request: unknown operation");
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "a", MG_PRODUCT);
+   mg_scratch_init(&scratch);
+   for (n = 0; n < max; n ++) {
+      cvars[n].ps = (unsigned char *) mg_get_string(PyTuple_GET_ITEM(args, n + 3), &scratch, &len);
+      cvars[n].size = len;
+   }
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
-   MG_MEMCHECK("Insufficient memory to process response", 0);
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
+   mg_buf_init(&request, MG_BUFSIZE, MG_BUFSIZE);
+   mg_request_global(p_page->p_srv, 0, &request, command, name, cvars, max);
+   mg_scratch_release(&scratch);
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
-      return NULL;
-   }
+   output = PyBytes_FromStringAndSize((char *) request.p_buffer, (Py_ssize_t) request.data_size);
+   mg_buf_free(&request);
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_tlevel(PyObject *self, PyObject *args)
+/* v2.4.50: the total size of a response, given (at least) its header, or -1 if the header is incomplete */
+static PyObject * ex_m_response_size(PyObject *self, PyObject *args)
 {
-   MGBUF mgbuf, *p_buf;
-   int n;
-   int chndle;
-   MGPAGE *p_page;
-   MGVARGS vargs;
-   PyObject *output;
+   long size;
+   Py_buffer data;
 
-   if (!PyArg_ParseTuple(args, "i", &(vargs.phndle))) {
+   if (!PyArg_ParseTuple(args, "s*", &data))
       return NULL;
+
+   size = -1;
+   if (data.len >= MG_RECV_HEAD) {
+      size = (long) mg_decode_size((unsigned char *) data.buf, 5, MG_CHUNK_SIZE_BASE) + MG_RECV_HEAD;
    }
+   PyBuffer_Release(&data);
 
-   p_page = mg_ppage(vargs.phndle);
+   return PyLong_FromLong(size);
+}
 
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
 
-   MG_FTRACE("m_tlevel");
+/* v2.4.50: decode a complete response, raising an exception if it reports an error */
+static PyObject * ex_m_response(PyObject *self, PyObject *args)
+{
+   unsigned long size;
+   char *p;
+   MGPAGE *p_page;
+   PyObject *output;
+   Py_buffer data;
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+   p_page = NULL;
+   if (!PyArg_ParseTuple(args, "s*|O&", &data, mg_get_page, &p_page))
       return NULL;
-   }
-
-   mg_request_header(p_page->p_srv, p_buf, "b", MG_PRODUCT);
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
-   MG_MEMCHECK("Insufficient memory to process response", 0);
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
-
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+   p = (char *) data.buf;
+   size = 0;
+   if (data.len >= MG_RECV_HEAD) {
+      size = mg_decode_size((unsigned char *) p, 5, MG_CHUNK_SIZE_BASE);
+   }
+   if (data.len < MG_RECV_HEAD || (unsigned long) data.len < (size + MG_RECV_HEAD)) {
+      PyBuffer_Release(&data);
+      MG_ERROR("mg_python: m_response: incomplete response");
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   if (!strncmp(p + 5, "ce", 2)) {
+      output = MG_MAKE_PYSTRINGN(p + MG_RECV_HEAD, (int) size);
+      if (output) {
+         PyErr_SetObject(PyExc_RuntimeError, output);
+         Py_DECREF(output);
+      }
+      output = NULL;
+   }
+   else {
+      output = MG_MAKE_PYDATAN(p_page, p + MG_RECV_HEAD, (int) size);
+   }
+   PyBuffer_Release(&data);
+
    return output;
 }
 
 
-static PyObject * ex_m_tcommit(PyObject *self, PyObject *args)
+static PyObject * ex_m_increment(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
-   int n;
+   int n, max;
+   int ifc[4];
    int chndle;
    MGPAGE *p_page;
    MGVARGS vargs;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "i", &(vargs.phndle))) {
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
-   }
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   MG_FTRACE("m_tcommit");
+   MG_FTRACE("m_increment");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "c", MG_PRODUCT);
+   if (mg_server_api_global(p_page->p_srv)) { /* v2.4.50 */
+      mg_invoke_server_api_global(p_page->p_srv, 0, 'I', vargs.global, vargs.cvars, max, p_buf);
+   }
+   else {
+      mg_request_header(p_page->p_srv, p_buf, "I", MG_PRODUCT);
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+
+      for (n = 0; n < max; n ++) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_DATA;
+         mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+      }
+
+      MG_MEMCHECK("Insufficient memory to process request", 1);
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+      MG_END_ALLOW_THREADS;
+   }
    MG_MEMCHECK("Insufficient memory to process response", 0);
    mg_db_disconnect(p_page->p_srv, chndle, 1);
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_trollback(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_iterate(PyObject *self, PyObject *args, PyObject *kwds)
 {
-   MGBUF mgbuf, *p_buf;
-   int n;
-   int chndle;
+   int n, max, direction, batch;
+   long limit;
+   PyObject *py_start, *py_end, *empty, *output;
    MGPAGE *p_page;
    MGVARGS vargs;
-   PyObject *output;
+   static char *kwlist[] = {"direction", "batch", "start", "end", "limit", NULL};
 
-   if (!PyArg_ParseTuple(args, "i", &(vargs.phndle))) {
+   if ((max = mg_get_vargs(self, MG_TUPLE_ARGS(args), &vargs, 0)) == -1)
       return NULL;
-   }
-
-   p_page = mg_ppage(vargs.phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
-
-   MG_FTRACE("m_trollback");
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   direction = 1;
+   batch = 0;
+   limit = 0;
+   py_start = NULL;
+   py_end = NULL;
+   empty = PyTuple_New(0);
+   if (!empty) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
+   n = PyArg_ParseTupleAndKeywords(empty, kwds, "|iiOOl", kwlist, &direction, &batch, &py_start, &py_end, &limit);
+   Py_DECREF(empty);
    if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "d", MG_PRODUCT);
-
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
-   MG_MEMCHECK("Insufficient memory to process response", 0);
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
-
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+   p_page = vargs.p_page;
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = mg_iterate_new(vargs.handle, vargs.global, vargs.cvars, max, direction, batch, py_start, py_end, limit, &(vargs.scratch));
+
+   mg_scratch_release(&vargs.scratch);
    return output;
 }
 
 
-static PyObject * ex_m_sleep(PyObject *self, PyObject *args)
+/* v2.4.50: an iterator over the subscripts below global(cvars): for m_iterate() and mglobal objects */
+PyObject * mg_iterate_new(PyObject *handle, char *global, MGSTR *cvars, int max, int direction, int batch, PyObject *py_start, PyObject *py_end, long limit, MGSCRATCH *p_scratch)
 {
-   int msecs;
+   int n, start_len, end_len;
+   char *start, *end;
+   MIterObject *iter;
 
-   if (!PyArg_ParseTuple(args, "i", &msecs))
+   iter = PyObject_New(MIterObject, &MIterType);
+   if (!iter) {
       return NULL;
+   }
 
-   mg_sleep((unsigned long) msecs);
-   msecs = 0;
+   iter->handle = handle;
+   Py_XINCREF(handle);
+   iter->direction = (direction < 0) ? -1 : 1;
+   iter->batch = (batch > 0) ? batch : MG_ITER_BATCH;
+   iter->batch_max = (batch > 0) ? 0 : MG_ITER_BATCH_MAX;
+   iter->limit = limit;
+   iter->count = 0;
+   iter->busy = 0;
+   iter->done = 0;
+   iter->inclusive = 0;
+   iter->max = max;
+   iter->item_offset = 0;
 
-   return Py_BuildValue("i", msecs);
+   n = mg_iterate_root(&(iter->data), &(iter->global), iter->cvars, global, cvars, max);
+   mg_buf_init(&(iter->key), 256, 256);
+   mg_buf_init(&(iter->end), 256, 256);
+   mg_buf_init(&(iter->items), MG_BUFSIZE, MG_BUFSIZE);
+
+   if (!n || !iter->key.p_buffer || !iter->end.p_buffer || !iter->items.p_buffer) {
+      Py_DECREF(iter);
+      MG_ERROR("Insufficient memory to process request");
+      return NULL;
+   }
+
+   if (py_start && py_start != Py_None) {
+      start = mg_get_string(py_start, p_scratch, &start_len);
+      if (start_len > 0) {
+         mg_buf_cpy(&(iter->key), start, start_len);
+         iter->inclusive = 1;
+      }
+   }
+   if (py_end && py_end != Py_None) {
+      end = mg_get_string(py_end, p_scratch, &end_len);
+      if (end_len > 0) {
+         mg_buf_cpy(&(iter->end), end, end_len);
+      }
+   }
+   iter->cvars[max].ps = iter->key.p_buffer;
+   iter->cvars[max].size = iter->key.data_size;
+
+   return (PyObject *) iter;
 }
 
 
-static PyObject * ex_ma_merge_to_db(PyObject *self, PyObject *args)
+/* v2.4.50: m_global(<dbhandle>, <global>, <leading subscripts> ...): a global node for repeated access to the nodes below it */
+static PyObject * ex_m_global(PyObject *self, MG_FASTCALL_ARGS)
 {
-   MGBUF mgbuf, *p_buf;
-   int n, max, mrec, rn, len;
-   int ifc[4];
-   char *global, *options, *ps;
-   MGSTR nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
-   PyObject *records;
-   PyObject *key;
-   PyObject *p;
-   PyObject *temp;
-   int chndle, phndle;
+   int max;
    MGPAGE *p_page;
-   PyObject *output;
+   MGVARGS vargs;
+   MGlobalObject *node;
 
-   if (!PyArg_ParseTuple(args, "isOOs", &phndle, &global, &key, &records, &options))
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   if (mg_type(key) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 3 to 'ma_merge_to_db' must be a list");
+   p_page = vargs.p_page;
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
-   if (mg_type(records) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 4 to 'ma_merge_to_db' must be a list");
+
+   node = PyObject_New(MGlobalObject, &MGlobalType);
+   if (!node) {
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
-
-   MG_FTRACE("ma_merge_to_db");
-
-   mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   node->handle = vargs.handle;
+   Py_INCREF(node->handle);
+   node->max = max;
+   node->header_len = 0;
+   node->p_srv = NULL;
+   mg_buf_init(&(node->request), 256, MG_BUFSIZE);
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+   if (!mg_iterate_root(&(node->data), &(node->global), node->cvars, vargs.global, vargs.cvars, max) || !node->request.p_buffer) {
+      Py_DECREF(node);
+      MG_ERROR("Insufficient memory to process request");
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "M", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) global, (int) strlen((char *) global), (short) ifc[0], (short) ifc[1]);
+   mg_scratch_release(&vargs.scratch);
+   return (PyObject *) node;
+}
 
-   for (n = 1; n <= max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) nkey[n].ps, nkey[n].size, (short) ifc[0], (short) ifc[1]);
-   }
 
-   ifc[0] = 0;
-   ifc[1] = MG_TX_AREC;
-   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+static void ex_mglobal_dealloc(MGlobalObject *self)
+{
+   mg_buf_free(&(self->data));
+   mg_buf_free(&(self->request));
+   Py_XDECREF(self->handle);
+   PyObject_Del(self);
+}
 
-   n = 0;
-   for (rn = 0; rn < mrec; rn ++) {
-      p = PyList_GetItem(records, rn);
-      ps = mg_get_string(p, &temp, &len);
 
-      if (rn == 0) {
-         ifc[0] = 0;
-         ifc[1] = MG_TX_AREC_FORMATTED;
+/* node[sub] or node[sub1, sub2, ...] for the data; node[start:end] (or node[end:start:-1]) for an iterator over the subscripts from start to end */
+static PyObject * ex_mglobal_subscript(MGlobalObject *self, PyObject *key)
+{
+   int direction;
+   PyObject *py_start, *py_end, *output;
+   PySliceObject *slice;
+   MGSCRATCH scratch;
+
+   if (PySlice_Check(key)) {
+      slice = (PySliceObject *) key;
+      direction = 1;
+      if (slice->step != Py_None) {
+         direction = mg_get_integer(slice->step);
+         if (direction != 1 && direction != -1) {
+            MG_ERROR("mg_python: mglobal: the step must be 1 or -1");
+            return NULL;
+         }
       }
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) ps, len, (short) ifc[0], (short) ifc[1]);
+      py_start = slice->start;
+      py_end = slice->stop;
+      mg_scratch_init(&scratch);
+      output = mg_iterate_new(self->handle, self->global, self->cvars, self->max, direction, 0, py_start, py_end, 0, &scratch);
+      mg_scratch_release(&scratch);
+      return output;
    }
-   ifc[0] = 0;
-   ifc[1] = MG_TX_EOD;
-   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) options, (int) strlen((char *) options), (short) ifc[0], (short) ifc[1]);
-
-   MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   return mg_global_node(self, 'G', key, NULL);
+}
 
-   MG_MEMCHECK("Insufficient memory to process response", 0);
 
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
+static int ex_mglobal_ass_subscript(MGlobalObject *self, PyObject *key, PyObject *value)
+{
+   PyObject *output;
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
-      return NULL;
+   output = mg_global_node(self, value ? 'S' : 'K', key, value);
+   if (!output) {
+      return -1;
    }
+   Py_DECREF(output);
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
-   return output;
+   return 0;
 }
 
 
-static PyObject * ex_ma_merge_from_db(PyObject *self, PyObject *args)
+/* sub in node: true if $Data(node(sub)) is non-zero */
+static int ex_mglobal_contains(MGlobalObject *self, PyObject *key)
 {
-
-   MGBUF mgbuf, *p_buf;
-   int n, max, mrec, anybyref;
-   int ifc[4];
-   char *global, *options;
-   MGSTR nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
-   PyObject *records;
-   PyObject *key;
-   PyObject *p;
-   int chndle, phndle;
-   MGPAGE *p_page;
+   int result;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isOOs", &phndle, &global, &key, &records, &options))
-      return NULL;
-
-   if (mg_type(key) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 3 to 'ma_merge_from_db' must be a list");
-      return NULL;
+   output = mg_global_node(self, 'D', key, NULL);
+   if (!output) {
+      return -1;
    }
-   if (mg_type(records) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 4 to 'ma_merge_from_db' must be a list");
-      return NULL;
+   if (PyBytes_Check(output)) { /* v2.4.50: m_set_bytes_mode() */
+      result = strtol(PyBytes_AS_STRING(output), NULL, 10) ? 1 : 0;
    }
-
-   p_page = mg_ppage(phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
-
-   MG_FTRACE("ma_merge_from_db");
-
-   mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
-
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
-      return NULL;
+   else {
+      result = mg_get_integer(output) ? 1 : 0;
    }
-
-   mg_request_header(p_page->p_srv, p_buf, "m", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) global, (int) strlen((char *) global), (short) ifc[0], (short) ifc[1]);
-
-   for (n = 1; n <= max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) nkey[n].ps, nkey[n].size, (short) ifc[0], (short) ifc[1]);
+   Py_DECREF(output);
+   if (PyErr_Occurred()) {
+      return -1;
    }
 
-   anybyref = 1;
-
-   ifc[0] = 1;
-   ifc[1] = MG_TX_AREC;
-   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
-   ifc[0] = 0;
-   ifc[1] = MG_TX_EOD;
-   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) options, (int) strlen((char *) options), (short) ifc[0], (short) ifc[1]);
+   return result;
+}
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+static PyObject * ex_mglobal_iter(MGlobalObject *self)
+{
+   PyObject *output;
+   MGSCRATCH scratch;
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   mg_scratch_init(&scratch);
+   output = mg_iterate_new(self->handle, self->global, self->cvars, self->max, 1, 0, NULL, NULL, 0, &scratch);
+   mg_scratch_release(&scratch);
 
-   MG_MEMCHECK("Insufficient memory to process response", 0);
+   return output;
+}
 
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
-      return NULL;
-   }
+static void ex_miter_dealloc(MIterObject *self)
+{
+   mg_buf_free(&(self->data));
+   mg_buf_free(&(self->key));
+   mg_buf_free(&(self->end));
+   mg_buf_free(&(self->items));
+   Py_XDECREF(self->handle);
+   PyObject_Del(self);
+}
 
-   if (anybyref) {
-      short byref, type, stop;
-      int n, n1, rn, hlen, size, clen, rlen, argc, rec_len;
-      unsigned char *parg, *par;
 
-      stop = 0;
-      parg = (p_buf->p_buffer + MG_RECV_HEAD);
+static PyObject * ex_miter_iternext(MIterObject *self)
+{
+   int rc;
+   unsigned long klen, vlen;
+   unsigned char *p;
+   MGBUF mgbuf, *p_buf;
+   MGPAGE *p_page;
+   PyObject *key, *value, *output;
 
-      clen = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
+   if (self->item_offset >= self->items.data_size) {
+      if (self->done) {
+         return NULL;
+      }
+      if (self->busy) {
+         MG_ERROR("mg_python: Iterator is already in use by another thread");
+         return NULL;
+      }
 
-      rlen = 0;
-      argc = 0;
-      for (n = 0;; n ++) {
-         hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
-         if ((hlen + size + rlen) > clen) {
-            stop = 1;
-            break;
-         }
-         parg += hlen;
-         rlen += hlen;
+      p_page = mg_handle_page(self->handle);
+      if (!p_page) {
+         return NULL;
+      }
 
-         parg += size;
-         rlen += size;
-         if (type == MG_TX_AREC) {
-            par = parg;
-            rn = 0;
-            rec_len = 0;
-            for (n1 = 0;; n1 ++) {
-               hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
-               if ((hlen + size + rlen) > clen) {
-                  stop = 1;
-                  break;
-               }
-               if (type == MG_TX_EOD) {
-                  parg += (hlen + size);
-                  rlen += (hlen + size);
-                  break;
-               }
-               parg += hlen;
-               rlen += hlen;
-               rec_len += hlen;
+      p_buf = &mgbuf;
+      mg_buf_get(p_page->p_srv, p_buf);
 
-               parg += size;
-               rlen += size;
-               rec_len += size;
-               if (type == MG_TX_DATA) {
+      MG_FTRACE("m_iterate");
 
-                  p = MG_MAKE_PYSTRINGN(par, rec_len);
-                  mg_set_list_item(records, rn ++, p);
+      self->busy = 1;
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      rc = mg_iterate_fetch(self, p_page->p_srv, p_buf);
+      MG_END_ALLOW_THREADS;
+      self->busy = 0;
 
-                  par = parg;
-                  rec_len = 0;
-               }
-            }
+      if (rc < 0) {
+         mg_buf_release(p_page->p_srv, p_buf);
+         MG_ERROR("Insufficient memory to process response");
+         return NULL;
+      }
+      if (rc == 0) {
+         self->done = 1;
+         if (p_buf->data_size > MG_RECV_HEAD) {
+            MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
          }
-         if (rlen >= clen || stop)
-            break;
-         argc ++;
+         else {
+            MG_ERROR(p_page->p_srv->error_mess);
+         }
+         mg_buf_release(p_page->p_srv, p_buf);
+         return NULL;
       }
-      if (stop) {
-         MG_ERROR("ma_merge_from_db: Bad return data");
-         mg_buf_free(p_buf);
+      mg_buf_release(p_page->p_srv, p_buf);
+
+      if (self->items.data_size == 0) {
          return NULL;
       }
-      output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-      mg_buf_free(p_buf);
-      return output;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   p = self->items.p_buffer + self->item_offset;
+   klen = mg_get_size(p);
+   p += 4;
+   key = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p, (int) klen);
+   p += klen;
+   vlen = mg_get_size(p);
+   p += 4;
+   value = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p, (int) vlen);
+   self->item_offset += (8 + klen + vlen);
+
+   if (!key || !value) {
+      Py_XDECREF(key);
+      Py_XDECREF(value);
+      return NULL;
+   }
+   output = PyTuple_Pack(2, key, value);
+   Py_DECREF(key);
+   Py_DECREF(value);
+
    return output;
 }
 
 
-static PyObject * ex_m_function(PyObject *self, PyObject *args)
+/* v2.4.50 */
+static PyObject * ex_m_query(PyObject *self, PyObject *args, PyObject *kwds)
 {
-   MGBUF mgbuf, *p_buf;
-   int n, max;
-   int ifc[4];
-   int chndle;
+   int n, max, direction, batch;
+   long limit;
+   PyObject *empty;
    MGPAGE *p_page;
    MGVARGS vargs;
-   PyObject *output;
+   MQueryObject *query;
+   static char *kwlist[] = {"direction", "batch", "limit", NULL};
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_TUPLE_ARGS(args), &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   direction = 1;
+   batch = 0;
+   limit = 0;
+   empty = PyTuple_New(0);
+   if (!empty) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
+   n = PyArg_ParseTupleAndKeywords(empty, kwds, "|iil", kwlist, &direction, &batch, &limit);
+   Py_DECREF(empty);
+   if (!n) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
 
-   MG_FTRACE("m_function");
+   p_page = vargs.p_page;
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
+   if (max >= MG_MAX_VARGS) {
+      MG_ERROR("mg_python: Too many subscripts");
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
 
-   n = mg_db_connect(p_page->p_srv, &chndle, 1);
-   if (!n) {
-      MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+   query = PyObject_New(MQueryObject, &MQueryType);
+   if (!query) {
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "X", MG_PRODUCT);
+   query->handle = vargs.handle;
+   Py_INCREF(query->handle);
+   query->direction = (direction < 0) ? -1 : 1;
+   query->batch = (batch > 0) ? batch : MG_ITER_BATCH;
+   query->batch_max = (batch > 0) ? 0 : MG_ITER_BATCH_MAX;
+   query->limit = limit;
+   query->count = 0;
+   query->busy = 0;
+   query->done = 0;
+   query->started = 0;
+   query->last_data = 0;
+   query->max = max;
+   query->depth = 0;
+   query->path_offset[0] = 0;
+   query->item_offset = 0;
 
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
+   /* The DB Server's own $Query is used where it is available (in-process YottaDB, forward direction) */
+   query->native = 0;
+   if (query->direction == 1 && mg_server_api_global(p_page->p_srv) && p_page->p_srv->pcon[0]->dbtype == DBX_DBTYPE_YOTTADB) {
+      query->native = 1;
+   }
 
-   for (n = 0; n < max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+   n = mg_iterate_root(&(query->data), &(query->global), query->cvars, vargs.global, vargs.cvars, max);
+   mg_buf_init(&(query->path), 256, 256);
+   mg_buf_init(&(query->items), MG_BUFSIZE, MG_BUFSIZE);
+
+   if (!n || !query->path.p_buffer || !query->items.p_buffer) {
+      Py_DECREF(query);
+      MG_ERROR("Insufficient memory to process request");
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
    }
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+   mg_scratch_release(&vargs.scratch);
+   return (PyObject *) query;
+}
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
-   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+static void ex_mquery_dealloc(MQueryObject *self)
+{
+   mg_buf_free(&(self->data));
+   mg_buf_free(&(self->path));
+   mg_buf_free(&(self->items));
+   Py_XDECREF(self->handle);
+   PyObject_Del(self);
+}
 
-   MG_MEMCHECK("Insufficient memory to process response", 0);
 
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
+static PyObject * ex_mquery_iternext(MQueryObject *self)
+{
+   int rc, n, nkeys;
+   unsigned long len;
+   unsigned char *p;
+   MGBUF mgbuf, *p_buf;
+   MGPAGE *p_page;
+   PyObject *keys, *item, *value, *output;
 
-   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
-      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+   if (self->item_offset >= self->items.data_size) {
+      if (self->done) {
+         return NULL;
+      }
+      if (self->busy) {
+         MG_ERROR("mg_python: Iterator is already in use by another thread");
+         return NULL;
+      }
+
+      p_page = mg_handle_page(self->handle);
+      if (!p_page) {
+         return NULL;
+      }
+
+      p_buf = &mgbuf;
+      mg_buf_get(p_page->p_srv, p_buf);
+
+      MG_FTRACE("m_query");
+
+      self->busy = 1;
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      rc = mg_query_fetch(self, p_page->p_srv, p_buf);
+      MG_END_ALLOW_THREADS;
+      self->busy = 0;
+
+      if (rc < 0) {
+         mg_buf_release(p_page->p_srv, p_buf);
+         MG_ERROR("Insufficient memory to process response");
+         return NULL;
+      }
+      if (rc == 0) {
+         self->done = 1;
+         if (p_buf->data_size > MG_RECV_HEAD) {
+            MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+         }
+         else {
+            MG_ERROR(p_page->p_srv->error_mess);
+         }
+         mg_buf_release(p_page->p_srv, p_buf);
+         return NULL;
+      }
+      mg_buf_release(p_page->p_srv, p_buf);
+
+      if (self->items.data_size == 0) {
+         return NULL;
+      }
+   }
+
+   /* Each item: <number of subscripts> (<length> <subscript>) ... <length> <value> */
+   p = self->items.p_buffer + self->item_offset;
+   nkeys = (int) mg_get_size(p);
+   p += 4;
+   keys = PyTuple_New(nkeys);
+   if (!keys) {
       return NULL;
    }
+   for (n = 0; n < nkeys; n ++) {
+      len = mg_get_size(p);
+      p += 4;
+      item = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p, (int) len);
+      p += len;
+      if (!item) {
+         Py_DECREF(keys);
+         return NULL;
+      }
+      PyTuple_SET_ITEM(keys, n, item);
+   }
+   len = mg_get_size(p);
+   p += 4;
+   value = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p, (int) len);
+   p += len;
+   self->item_offset = (unsigned long) (p - self->items.p_buffer);
+
+   if (!value) {
+      Py_DECREF(keys);
+      return NULL;
+   }
+   output = PyTuple_Pack(2, keys, value);
+   Py_DECREF(keys);
+   Py_DECREF(value);
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
    return output;
 }
 
 
-static PyObject * ex_ma_function(PyObject *self, PyObject *args)
+static PyObject * ex_m_tstart(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, an, t, argn, chndle, phndle, len, anybyref, ret_size;
-   int types[32];
-   int byrefs[32];
-   int ifc[4];
-   char bstr[256], bstr1[256];
-   MGSTR properties[MG_MAX_KEY];
-   char *str;
-   char *fun;
-   char *ret;
-   PyObject *a_list;
-   PyObject *a;
-   PyObject *pstr;
-   PyObject *p;
+   int n;
+   int chndle;
    MGPAGE *p_page;
-   char buffer[256];
+   MGVARGS vargs;
    PyObject *output;
 
-   *buffer = '\0';
+   if (!mg_parse_handle(self, args, &p_page)) {
+      return NULL;
+   }
 
-   /* return MG_MAKE_PYSTRINGN(buffer, (int) strlen(buffer)); */
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   if (!PyArg_ParseTuple(args, "isOi", &phndle, &fun, &a_list, &argn))
-      return NULL;
+   MG_FTRACE("m_tstart");
 
-   if (mg_type(a_list) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 3 to 'ma_function' must be a list");
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   /* return MG_MAKE_PYSTRINGN(fun, (int) strlen(fun)); */
-
-   p_page = mg_ppage(phndle);
-
-   p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_request_header(p_page->p_srv, p_buf, "a", MG_PRODUCT);
 
-   MG_FTRACE("ma_function");
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+   mg_pool_transaction(p_page->p_srv, chndle, "a", p_buf); /* v2.4.50 */
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
 
-   pstr = PyList_GetItem(a_list, 0);
-   str = NULL;
-   strcpy(bstr, "");
-   strcpy(bstr1, "");
-   if (pstr)
-      str = (char *) MG_GET_PYSTRING(pstr);
-   if (str) {
-      strcpy(bstr, str);
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
    }
 
-   /* return MG_MAKE_PYSTRINGN(bstr, (int) strlen(bstr)); */
+   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
 
-   max = mg_extract_substrings(properties, bstr, (int) strlen(bstr), '#', 0, 0, MG_ES_DELIM);
 
-   anybyref = 0;
-   for (an = 1; an < 32; an ++) {
-      if (an < max) {
-         if (properties[an].ps[0] == '1')
-            types[an] = 1;
-         else
-            types[an] = 0;
-         if (properties[an].ps[1] == '1') {
-            byrefs[an] = 1;
-            anybyref = 1;
-         }
-         else
-            byrefs[an] = 0;
-      }
-      else {
-         types[an] = 0;
-         byrefs[an] = 0;
-      }
+static PyObject * ex_m_tlevel(PyObject *self, PyObject *args)
+{
+   MGBUF mgbuf, *p_buf;
+   int n;
+   int chndle;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *output;
+
+   if (!mg_parse_handle(self, args, &p_page)) {
+      return NULL;
    }
 
-   chndle = 0;
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   max = 0;
+   MG_FTRACE("m_tlevel");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "X", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) fun, (int) strlen((char *) fun), (short) ifc[0], (short) ifc[1]);
-
-   for (an = 1; an <= argn; an ++) {
+   mg_request_header(p_page->p_srv, p_buf, "b", MG_PRODUCT);
 
-      str = NULL;
-      pstr = PyList_GetItem(a_list, an);
-      if (pstr) {
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+   mg_pool_transaction(p_page->p_srv, chndle, "b", p_buf); /* v2.4.50 */
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
 
-         if (byrefs[an])
-            ifc[0] = 1;
-         else
-            ifc[0] = 0;
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
 
-         t = mg_type(pstr);
-         if (t == MG_T_LIST) {
+   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
 
-            int max, n;
 
-            ifc[1] = MG_TX_AREC;
-            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+static PyObject * ex_m_tcommit(PyObject *self, PyObject *args)
+{
+   MGBUF mgbuf, *p_buf;
+   int n;
+   int chndle;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *output;
 
-            ifc[1] = MG_TX_AREC_FORMATTED;
+   if (!mg_parse_handle(self, args, &p_page)) {
+      return NULL;
+   }
 
-            max = (int) PyList_Size(pstr);
-            for (n = 0; n < max; n ++) {
-               a = PyList_GetItem(pstr, n);
-               str = mg_get_string(a, &p, &len);
-               mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
-            }
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-            ifc[1] = MG_TX_EOD;
-            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+   MG_FTRACE("m_tcommit");
 
-         }
-         else {
-            str = mg_get_string(pstr, &p, &n);
-            ifc[1] = MG_TX_DATA;
-            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, (int) strlen((char *) str), (short) ifc[0], (short) ifc[1]);
-         }
-      }
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
    }
 
-#if 0
-{
-   mg_db_disconnect(p_page->p_srv, chndle, 1);
-   return MG_MAKE_PYSTRINGN(p_buf->p_buffer, (int) strlen(p_buf->p_buffer));
-   /* return MG_MAKE_PYSTRINGN(buffer, (int) strlen(buffer)); */
-}
-#endif
+   mg_request_header(p_page->p_srv, p_buf, "c", MG_PRODUCT);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
-
+   MG_END_ALLOW_THREADS;
    MG_MEMCHECK("Insufficient memory to process response", 0);
-
+   mg_pool_transaction(p_page->p_srv, chndle, "c", p_buf); /* v2.4.50 */
    mg_db_disconnect(p_page->p_srv, chndle, 1);
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   if (anybyref) {
-      short byref, type, stop;
-      int n, n1, rn, hlen, size, clen, rlen, argc, rec_len, argoffs;
-      unsigned char *parg, *par;
+   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
 
-      ret = (char *) (p_buf->p_buffer + MG_RECV_HEAD);
-      ret_size = p_buf->data_size - MG_RECV_HEAD;
 
-      argoffs = 2;
-      stop = 0;
-      parg = (p_buf->p_buffer + MG_RECV_HEAD);
+static PyObject * ex_m_trollback(PyObject *self, PyObject *args)
+{
+   MGBUF mgbuf, *p_buf;
+   int n;
+   int chndle;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *output;
 
-      clen = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
+   if (!mg_parse_handle(self, args, &p_page)) {
+      return NULL;
+   }
 
-      rlen = 0;
-      argc = 0;
-      for (n = 0;; n ++) {
-         hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
-         if ((hlen + size + rlen) > clen) {
-            stop = 1;
-            break;
-         }
-         parg += hlen;
-         rlen += hlen;
-         an = argc - argoffs;
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-         if (an > 0) {
-            pstr = PyList_GetItem(a_list, an);
-            if (pstr)
-               t = mg_type(pstr);
-         }
-         else
-            pstr = NULL;
+   MG_FTRACE("m_trollback");
 
-         if (argc == 0) {
-               ret = (char *) parg;
-               ret_size = size;
-         }
-         else if (pstr && type == MG_TX_DATA) {
-            p = MG_MAKE_PYSTRINGN(parg, size);
-            mg_set_list_item(a_list, an, p);
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   mg_request_header(p_page->p_srv, p_buf, "d", MG_PRODUCT);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+   mg_pool_transaction(p_page->p_srv, chndle, "d", p_buf); /* v2.4.50 */
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
+
+
+static PyObject * ex_m_sleep(PyObject *self, PyObject *args)
+{
+   int msecs;
+
+   if (!PyArg_ParseTuple(args, "i", &msecs))
+      return NULL;
+
+   mg_sleep((unsigned long) msecs);
+   msecs = 0;
+
+   return Py_BuildValue("i", msecs);
+}
+
+
+static PyObject * ex_ma_merge_to_db(PyObject *self, PyObject *args)
+{
+   MGBUF mgbuf, *p_buf;
+   int n, max, mrec, rn, len, stream;
+   unsigned long size;
+   int ifc[4];
+   char *global, *options, *ps;
+   MGSTR nkey[MG_MAX_KEY];
+   MGSCRATCH scratch, rscratch;
+   PyObject *records;
+   PyObject *key;
+   PyObject *p;
+   int chndle;
+   MGPAGE *p_page;
+   PyObject *output;
+
+   if (!PyArg_ParseTuple(args, "O&sOOs", mg_get_page, &p_page, &global, &key, &records, &options))
+      return NULL;
+
+   if (mg_type(key) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 3 to 'ma_merge_to_db' must be a list");
+      return NULL;
+   }
+   if (mg_type(records) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 4 to 'ma_merge_to_db' must be a list");
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
+   mg_scratch_init(&rscratch);
+
+   MG_FTRACE("ma_merge_to_db");
+
+   mrec = (int) PyList_Size(records);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   mg_request_header(p_page->p_srv, p_buf, "M", MG_PRODUCT);
+
+   /* v2.4.50: size the payload in advance so that large merges can be streamed to the DB Server in chunks */
+   size = mg_request_add_size((int) strlen((char *) global), 0, MG_TX_DATA);
+   for (n = 1; n <= max; n ++) {
+      size += mg_request_add_size(nkey[n].size, 0, MG_TX_DATA);
+   }
+   size += mg_request_add_size(0, 0, MG_TX_AREC);
+   /* v2.4.50: the text of a record is only needed until it has been measured (or copied to the request), so each record reuses the same scratch space */
+   for (rn = 0; rn < mrec; rn ++) {
+      mg_get_string(PyList_GetItem(records, rn), &rscratch, &len);
+      mg_scratch_release(&rscratch);
+      size += mg_request_add_size(len, 0, MG_TX_AREC_FORMATTED);
+   }
+   size += mg_request_add_size(0, 0, MG_TX_EOD);
+   size += mg_request_add_size((int) strlen((char *) options), 0, MG_TX_DATA);
+   stream = mg_request_stream(p_page->p_srv, p_buf, size);
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) global, (int) strlen((char *) global), (short) ifc[0], (short) ifc[1]);
+
+   for (n = 1; n <= max; n ++) {
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) nkey[n].ps, nkey[n].size, (short) ifc[0], (short) ifc[1]);
+   }
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_AREC;
+   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+   n = 0;
+   for (rn = 0; rn < mrec; rn ++) {
+      p = PyList_GetItem(records, rn);
+      ps = mg_get_string(p, &rscratch, &len);
+
+      if (rn == 0) {
+         ifc[0] = 0;
+         ifc[1] = MG_TX_AREC_FORMATTED;
+      }
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) ps, len, (short) ifc[0], (short) ifc[1]);
+      mg_scratch_release(&rscratch);
+
+      if (stream && p_buf->data_size >= MG_STREAM_CHUNK) { /* v2.4.50 */
+         MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+         mg_db_send(p_page->p_srv, chndle, p_buf, 0);
+         MG_END_ALLOW_THREADS;
+         p_buf->data_size = 0;
+      }
+   }
+   ifc[0] = 0;
+   ifc[1] = MG_TX_EOD;
+   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) options, (int) strlen((char *) options), (short) ifc[0], (short) ifc[1]);
+
+   MG_MEMCHECK("Insufficient memory to process request", 1);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, stream ? 0 : 1);
+
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
+
+
+static PyObject * ex_ma_merge_from_db(PyObject *self, PyObject *args)
+{
+
+   MGBUF mgbuf, *p_buf;
+   int n, max, mrec, anybyref;
+   int ifc[4];
+   char *global, *options;
+   MGSTR nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
+   PyObject *records;
+   PyObject *key;
+   PyObject *p;
+   int chndle;
+   MGPAGE *p_page;
+   PyObject *output;
+
+   if (!PyArg_ParseTuple(args, "O&sOOs", mg_get_page, &p_page, &global, &key, &records, &options))
+      return NULL;
+
+   if (mg_type(key) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 3 to 'ma_merge_from_db' must be a list");
+      return NULL;
+   }
+   if (mg_type(records) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 4 to 'ma_merge_from_db' must be a list");
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
+
+   MG_FTRACE("ma_merge_from_db");
+
+   mrec = (int) PyList_Size(records);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   mg_request_header(p_page->p_srv, p_buf, "m", MG_PRODUCT);
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) global, (int) strlen((char *) global), (short) ifc[0], (short) ifc[1]);
+
+   for (n = 1; n <= max; n ++) {
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) nkey[n].ps, nkey[n].size, (short) ifc[0], (short) ifc[1]);
+   }
+
+   anybyref = 1;
+
+   ifc[0] = 1;
+   ifc[1] = MG_TX_AREC;
+   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+   ifc[0] = 0;
+   ifc[1] = MG_TX_EOD;
+   mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) options, (int) strlen((char *) options), (short) ifc[0], (short) ifc[1]);
+
+   MG_MEMCHECK("Insufficient memory to process request", 1);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   if (anybyref) {
+      short byref, type, stop;
+      int n, n1, rn, hlen, size, clen, rlen, argc, rec_len;
+      unsigned char *parg, *par;
+
+      stop = 0;
+      parg = (p_buf->p_buffer + MG_RECV_HEAD);
+
+      clen = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
+
+      rlen = 0;
+      argc = 0;
+      for (n = 0;; n ++) {
+         hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
+         if ((hlen + size + rlen) > clen) {
+            stop = 1;
+            break;
          }
+         parg += hlen;
+         rlen += hlen;
 
          parg += size;
          rlen += size;
          if (type == MG_TX_AREC) {
-
-            if (pstr && t == MG_T_LIST)
-               mg_kill_list(pstr);
-
             par = parg;
             rn = 0;
             rec_len = 0;
@@ -2167,10 +3511,8 @@ static PyObject * ex_ma_function(PyObject *self, PyObject *args)
                rec_len += size;
                if (type == MG_TX_DATA) {
 
-                  if (pstr && t == MG_T_LIST) {
-                     p = MG_MAKE_PYSTRINGN(par, rec_len);
-                     mg_set_list_item(pstr, rn ++, p);
-                  }
+                  p = MG_MAKE_PYDATAN(p_page, par, rec_len);
+                  mg_set_list_item(records, rn ++, p);
 
                   par = parg;
                   rec_len = 0;
@@ -2182,22 +3524,25 @@ static PyObject * ex_ma_function(PyObject *self, PyObject *args)
          argc ++;
       }
       if (stop) {
-         MG_ERROR("ma_function: Bad return data");
-         mg_buf_free(p_buf);
+         MG_ERROR("ma_merge_from_db: Bad return data");
+         mg_scratch_release(&scratch);
+         mg_buf_release(p_page->p_srv, p_buf);
          return NULL;
       }
-      output = MG_MAKE_PYSTRINGN(ret, ret_size);
-      mg_buf_free(p_buf);
+      output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return output;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_m_classmethod(PyObject *self, PyObject *args)
+static PyObject * ex_m_function(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -2207,24 +3552,27 @@ static PyObject * ex_m_classmethod(PyObject *self, PyObject *args)
    MGVARGS vargs;
    PyObject *output;
 
-   if ((max = mg_get_vargs(args, &vargs, 0)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   MG_FTRACE("m_classmethod");
+   MG_FTRACE("m_function");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "x", MG_PRODUCT);
+   mg_request_header(p_page->p_srv, p_buf, "X", MG_PRODUCT);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
@@ -2238,9 +3586,11 @@ static PyObject * ex_m_classmethod(PyObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -2248,67 +3598,58 @@ static PyObject * ex_m_classmethod(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   if (!strncmp((char *) p_buf->p_buffer + 5, "co", 2)) { /* v2.4.48 */
-      int oref;
-
-      p_buf->p_buffer[p_buf->data_size] = '\0';
-      oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
-      PyObject *argList = Py_BuildValue("sii", "mclass", oref, vargs.phndle);
-
-      /* Call the class object. */
-      PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
-
-      /* Release the argument list. */
-      Py_DECREF(argList);
-
-      return obj;
-   }
-
-
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
+static PyObject * ex_ma_function(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, an, t, argn, chndle, phndle, anybyref, ret_size, len;
+   int n, max, an, t, argn, chndle, len, anybyref, ret_size;
    int types[32];
    int byrefs[32];
    int ifc[4];
    char bstr[256], bstr1[256];
    MGSTR properties[MG_MAX_KEY];
    char *str;
-   char *cclass;
-   char *cmethod;
+   char *fun;
    char *ret;
    PyObject *a_list;
    PyObject *a;
    PyObject *pstr;
    PyObject *p;
    MGPAGE *p_page;
+   char buffer[256];
    PyObject *output;
+   MGSCRATCH scratch;
+
+   *buffer = '\0';
+
+   /* return MG_MAKE_PYSTRINGN(buffer, (int) strlen(buffer)); */
 
-   if (!PyArg_ParseTuple(args, "issOi", &phndle, &cclass, &cmethod, &a_list, &argn))
+   if (!PyArg_ParseTuple(args, "O&sOi", mg_get_page, &p_page, &fun, &a_list, &argn))
       return NULL;
 
    if (mg_type(a_list) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 4 to 'ma_classmethod' must be a list");
+      MG_ERROR("mg_python: Argument 3 to 'ma_function' must be a list");
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
+   /* return MG_MAKE_PYSTRINGN(fun, (int) strlen(fun)); */
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
-   MG_FTRACE("ma_classmethod");
+   MG_FTRACE("ma_function");
 
    pstr = PyList_GetItem(a_list, 0);
    str = NULL;
@@ -2320,6 +3661,8 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
       strcpy(bstr, str);
    }
 
+   /* return MG_MAKE_PYSTRINGN(bstr, (int) strlen(bstr)); */
+
    max = mg_extract_substrings(properties, bstr, (int) strlen(bstr), '#', 0, 0, MG_ES_DELIM);
 
    anybyref = 0;
@@ -2346,22 +3689,21 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
 
    max = 0;
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "x", MG_PRODUCT);
-
-   ifc[0] = 0;
-   ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) cclass, (int) strlen((char *) cclass), (short) ifc[0], (short) ifc[1]);
+   mg_request_header(p_page->p_srv, p_buf, "X", MG_PRODUCT);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) cmethod, (int) strlen((char *) cmethod), (short) ifc[0], (short) ifc[1]);
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) fun, (int) strlen((char *) fun), (short) ifc[0], (short) ifc[1]);
 
    for (an = 1; an <= argn; an ++) {
 
@@ -2387,7 +3729,7 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
             max = (int) PyList_Size(pstr);
             for (n = 0; n < max; n ++) {
                a = PyList_GetItem(pstr, n);
-               str = mg_get_string(a, &p, &len);
+               str = mg_get_string(a, &scratch, &len);
                mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
             }
 
@@ -2396,17 +3738,25 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
 
          }
          else {
-            str = mg_get_string(pstr, &p, &n);
-
+            str = mg_get_string(pstr, &scratch, &n);
             ifc[1] = MG_TX_DATA;
-
-            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, (int) strlen((char *) str), (short) ifc[0], (short) ifc[1]);
+            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, n, (short) ifc[0], (short) ifc[1]);
          }
       }
    }
 
+#if 0
+{
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+   return MG_MAKE_PYSTRINGN(p_buf->p_buffer, (int) strlen(p_buf->p_buffer));
+   /* return MG_MAKE_PYSTRINGN(buffer, (int) strlen(buffer)); */
+}
+#endif
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -2414,7 +3764,8 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -2426,7 +3777,7 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
       ret = (char *) (p_buf->p_buffer + MG_RECV_HEAD);
       ret_size = p_buf->data_size - MG_RECV_HEAD;
 
-      argoffs = 3;
+      argoffs = 2;
       stop = 0;
       parg = (p_buf->p_buffer + MG_RECV_HEAD);
 
@@ -2457,7 +3808,7 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
                ret_size = size;
          }
          else if (pstr && type == MG_TX_DATA) {
-            p = MG_MAKE_PYSTRINGN(parg, size);
+            p = MG_MAKE_PYDATAN(p_page, parg, size);
             mg_set_list_item(a_list, an, p);
          }
 
@@ -2492,7 +3843,7 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
                if (type == MG_TX_DATA) {
 
                   if (pstr && t == MG_T_LIST) {
-                     p = MG_MAKE_PYSTRINGN(par, rec_len);
+                     p = MG_MAKE_PYDATAN(p_page, par, rec_len);
                      mg_set_list_item(pstr, rn ++, p);
                   }
 
@@ -2506,100 +3857,59 @@ static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
          argc ++;
       }
       if (stop) {
-         MG_ERROR("ma_classmethod: Bad return data");
-         mg_buf_free(p_buf);
+         MG_ERROR("ma_function: Bad return data");
+         mg_scratch_release(&scratch);
+         mg_buf_release(p_page->p_srv, p_buf);
          return NULL;
       }
-      output = MG_MAKE_PYSTRINGN(ret, ret_size);
-      mg_buf_free(p_buf);
+      output = MG_MAKE_PYDATAN(p_page, ret, ret_size);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return output;
    }
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
-   return output;
-}
 
-
-/* v2.4.48 */
-static void ex_mclass_dealloc(MClassObject *self)
-{
-    Py_XDECREF(self->class_name);
-    Py_TYPE(self)->tp_free((PyObject *) self);
-}
-
-
-static PyObject * ex_mclass_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
-{
-    MClassObject *self;
-    self = (MClassObject *) type->tp_alloc(type, 0);
-    if (self != NULL) {
-        self->class_name = PyUnicode_FromString("");
-        if (self->class_name == NULL) {
-            Py_DECREF(self);
-            return NULL;
-        }
-        self->oref = 0;
-    }
-    return (PyObject *) self;
-}
-
-
-static int ex_mclass_init(MClassObject *self, PyObject *args, PyObject *kwds)
-{
-    static char *kwlist[] = {"class_name", "oref", "phndle", NULL};
-    PyObject *class_name = NULL, *tmp;
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|Oii", kwlist, &class_name, &self->oref, &self->phndle))
-        return -1;
-
-    if (class_name) {
-        tmp = self->class_name;
-        Py_INCREF(class_name);
-        self->class_name = class_name;
-        Py_XDECREF(tmp);
-    }
-
-    return 0;
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
 }
 
 
-static PyObject * ex_mclass_method(MClassObject *self, PyObject *args)
+static PyObject * ex_m_classmethod(PyObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
    int ifc[4];
    int chndle;
-   char buffer[32];
    MGPAGE *p_page;
    MGVARGS vargs;
    PyObject *output;
 
-   if (!self)
-      return NULL;
-   if ((max = mg_get_vargs(args, &vargs, 1)) == -1)
+   if ((max = mg_get_vargs(self, MG_FASTCALL_PASS, &vargs, 0)) == -1)
       return NULL;
 
-   vargs.phndle = self->phndle;
-   p_page = mg_ppage(vargs.phndle);
+   p_page = vargs.p_page;
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   MG_FTRACE("mclass_method");
+   MG_FTRACE("m_classmethod");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "j", MG_PRODUCT);
+   mg_request_header(p_page->p_srv, p_buf, "x", MG_PRODUCT);
 
-   sprintf(buffer, "%d", self->oref);
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) buffer, (int) strlen((char *) buffer), (short) ifc[0], (short) ifc[1]);
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.global, (int) strlen((char *) vargs.global), (short) ifc[0], (short) ifc[1]);
 
    for (n = 0; n < max; n ++) {
       ifc[0] = 0;
@@ -2609,9 +3919,11 @@ static PyObject * ex_mclass_method(MClassObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -2619,7 +3931,8 @@ static PyObject * ex_mclass_method(MClassObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -2628,7 +3941,7 @@ static PyObject * ex_mclass_method(MClassObject *self, PyObject *args)
 
       p_buf->p_buffer[p_buf->data_size] = '\0';
       oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
-      PyObject *argList = Py_BuildValue("sii", "mclass", oref, vargs.phndle);
+      PyObject *argList = Py_BuildValue("siO", "mclass", oref, vargs.handle ? vargs.handle : Py_None);
 
       /* Call the class object. */
       PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
@@ -2636,64 +3949,156 @@ static PyObject * ex_mclass_method(MClassObject *self, PyObject *args)
       /* Release the argument list. */
       Py_DECREF(argList);
 
+      mg_scratch_release(&vargs.scratch); /* v2.4.50 */
+      mg_buf_release(p_page->p_srv, p_buf);
       return obj;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_mclass_getproperty(MClassObject *self, PyObject *args)
+static PyObject * ex_ma_classmethod(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max;
+   int n, max, an, t, argn, chndle, anybyref, ret_size, len;
+   int types[32];
+   int byrefs[32];
    int ifc[4];
-   int chndle;
-   char buffer[32];
+   char bstr[256], bstr1[256];
+   MGSTR properties[MG_MAX_KEY];
+   char *str;
+   char *cclass;
+   char *cmethod;
+   char *ret;
+   PyObject *a_list;
+   PyObject *a;
+   PyObject *pstr;
+   PyObject *p;
    MGPAGE *p_page;
-   MGVARGS vargs;
    PyObject *output;
+   MGSCRATCH scratch;
 
-   if (!self)
-      return NULL;
-   if ((max = mg_get_vargs(args, &vargs, 1)) == -1)
+   if (!PyArg_ParseTuple(args, "O&ssOi", mg_get_page, &p_page, &cclass, &cmethod, &a_list, &argn))
       return NULL;
 
-   vargs.phndle = self->phndle;
-   p_page = mg_ppage(vargs.phndle);
+   if (mg_type(a_list) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 4 to 'ma_classmethod' must be a list");
+      return NULL;
+   }
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
-   MG_FTRACE("mclass_getproperty");
+   MG_FTRACE("ma_classmethod");
+
+   pstr = PyList_GetItem(a_list, 0);
+   str = NULL;
+   strcpy(bstr, "");
+   strcpy(bstr1, "");
+   if (pstr)
+      str = (char *) MG_GET_PYSTRING(pstr);
+   if (str) {
+      strcpy(bstr, str);
+   }
+
+   max = mg_extract_substrings(properties, bstr, (int) strlen(bstr), '#', 0, 0, MG_ES_DELIM);
+
+   anybyref = 0;
+   for (an = 1; an < 32; an ++) {
+      if (an < max) {
+         if (properties[an].ps[0] == '1')
+            types[an] = 1;
+         else
+            types[an] = 0;
+         if (properties[an].ps[1] == '1') {
+            byrefs[an] = 1;
+            anybyref = 1;
+         }
+         else
+            byrefs[an] = 0;
+      }
+      else {
+         types[an] = 0;
+         byrefs[an] = 0;
+      }
+   }
+
+   chndle = 0;
 
+   max = 0;
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "h", MG_PRODUCT);
+   mg_request_header(p_page->p_srv, p_buf, "x", MG_PRODUCT);
 
-   sprintf(buffer, "%d", self->oref);
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) buffer, (int) strlen((char *) buffer), (short) ifc[0], (short) ifc[1]);
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) cclass, (int) strlen((char *) cclass), (short) ifc[0], (short) ifc[1]);
 
-   for (n = 0; n < max; n ++) {
-      ifc[0] = 0;
-      ifc[1] = MG_TX_DATA;
-      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
-   }
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) cmethod, (int) strlen((char *) cmethod), (short) ifc[0], (short) ifc[1]);
 
-   MG_MEMCHECK("Insufficient memory to process request", 1);
+   for (an = 1; an <= argn; an ++) {
 
-   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+      str = NULL;
+      pstr = PyList_GetItem(a_list, an);
+      if (pstr) {
+
+         if (byrefs[an])
+            ifc[0] = 1;
+         else
+            ifc[0] = 0;
+
+         t = mg_type(pstr);
+         if (t == MG_T_LIST) {
+
+            int max, n;
+
+            ifc[1] = MG_TX_AREC;
+            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+            ifc[1] = MG_TX_AREC_FORMATTED;
+
+            max = (int) PyList_Size(pstr);
+            for (n = 0; n < max; n ++) {
+               a = PyList_GetItem(pstr, n);
+               str = mg_get_string(a, &scratch, &len);
+               mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
+            }
+
+            ifc[1] = MG_TX_EOD;
+            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+         }
+         else {
+            str = mg_get_string(pstr, &scratch, &n);
+
+            ifc[1] = MG_TX_DATA;
+
+            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, n, (short) ifc[0], (short) ifc[1]);
+         }
+      }
+   }
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -2701,33 +4106,168 @@ static PyObject * ex_mclass_getproperty(MClassObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   if (!strncmp((char *) p_buf->p_buffer + 5, "co", 2)) { /* v2.4.48 */
-      int oref;
+   if (anybyref) {
+      short byref, type, stop;
+      int n, n1, rn, hlen, size, clen, rlen, argc, rec_len, argoffs;
+      unsigned char *parg, *par;
 
-      p_buf->p_buffer[p_buf->data_size] = '\0';
-      oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
-      PyObject *argList = Py_BuildValue("sii", "mclass", oref, vargs.phndle);
+      ret = (char *) (p_buf->p_buffer + MG_RECV_HEAD);
+      ret_size = p_buf->data_size - MG_RECV_HEAD;
 
-      /* Call the class object. */
-      PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
+      argoffs = 3;
+      stop = 0;
+      parg = (p_buf->p_buffer + MG_RECV_HEAD);
 
-      /* Release the argument list. */
-      Py_DECREF(argList);
+      clen = mg_decode_size(p_buf->p_buffer, 5, MG_CHUNK_SIZE_BASE);
 
-      return obj;
-   }
+      rlen = 0;
+      argc = 0;
+      for (n = 0;; n ++) {
+         hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
+         if ((hlen + size + rlen) > clen) {
+            stop = 1;
+            break;
+         }
+         parg += hlen;
+         rlen += hlen;
+         an = argc - argoffs;
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+         if (an > 0) {
+            pstr = PyList_GetItem(a_list, an);
+            if (pstr)
+               t = mg_type(pstr);
+         }
+         else
+            pstr = NULL;
+
+         if (argc == 0) {
+               ret = (char *) parg;
+               ret_size = size;
+         }
+         else if (pstr && type == MG_TX_DATA) {
+            p = MG_MAKE_PYDATAN(p_page, parg, size);
+            mg_set_list_item(a_list, an, p);
+         }
+
+         parg += size;
+         rlen += size;
+         if (type == MG_TX_AREC) {
+
+            if (pstr && t == MG_T_LIST)
+               mg_kill_list(pstr);
+
+            par = parg;
+            rn = 0;
+            rec_len = 0;
+            for (n1 = 0;; n1 ++) {
+               hlen = mg_decode_item_header(parg, &size, (short *) &byref, (short *) &type);
+               if ((hlen + size + rlen) > clen) {
+                  stop = 1;
+                  break;
+               }
+               if (type == MG_TX_EOD) {
+                  parg += (hlen + size);
+                  rlen += (hlen + size);
+                  break;
+               }
+               parg += hlen;
+               rlen += hlen;
+               rec_len += hlen;
+
+               parg += size;
+               rlen += size;
+               rec_len += size;
+               if (type == MG_TX_DATA) {
+
+                  if (pstr && t == MG_T_LIST) {
+                     p = MG_MAKE_PYDATAN(p_page, par, rec_len);
+                     mg_set_list_item(pstr, rn ++, p);
+                  }
+
+                  par = parg;
+                  rec_len = 0;
+               }
+            }
+         }
+         if (rlen >= clen || stop)
+            break;
+         argc ++;
+      }
+      if (stop) {
+         MG_ERROR("ma_classmethod: Bad return data");
+         mg_scratch_release(&scratch);
+         mg_buf_release(p_page->p_srv, p_buf);
+         return NULL;
+      }
+      output = MG_MAKE_PYDATAN(p_page, ret, ret_size);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return output;
+   }
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
+/* v2.4.48 */
+static void ex_mclass_dealloc(MClassObject *self)
+{
+    Py_XDECREF(self->class_name);
+    Py_XDECREF(self->handle);
+    Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+
+static PyObject * ex_mclass_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    MClassObject *self;
+    self = (MClassObject *) type->tp_alloc(type, 0);
+    if (self != NULL) {
+        self->class_name = PyUnicode_FromString("");
+        if (self->class_name == NULL) {
+            Py_DECREF(self);
+            return NULL;
+        }
+        self->oref = 0;
+    }
+    return (PyObject *) self;
+}
+
+
+static int ex_mclass_init(MClassObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"class_name", "oref", "phndle", NULL};
+    PyObject *class_name = NULL, *handle = NULL, *tmp;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|OiO", kwlist, &class_name, &self->oref, &handle))
+        return -1;
+
+    if (handle && handle != Py_None) { /* v2.4.50: a Connection or the number of a page */
+        tmp = self->handle;
+        Py_INCREF(handle);
+        self->handle = handle;
+        Py_XDECREF(tmp);
+    }
+
+    if (class_name) {
+        tmp = self->class_name;
+        Py_INCREF(class_name);
+        self->class_name = class_name;
+        Py_XDECREF(tmp);
+    }
+
+    return 0;
+}
+
+
+static PyObject * ex_mclass_method(MClassObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
    int n, max;
@@ -2740,25 +4280,32 @@ static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
 
    if (!self)
       return NULL;
-   if ((max = mg_get_vargs(args, &vargs, 1)) == -1)
+   if ((max = mg_get_vargs(NULL, MG_FASTCALL_PASS, &vargs, 1)) == -1)
       return NULL;
 
-   vargs.phndle = self->phndle;
-   p_page = mg_ppage(vargs.phndle);
+   vargs.handle = self->handle;
+   p_page = mg_handle_page(self->handle);
+   if (!p_page) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
 
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   MG_FTRACE("mclass_setproperty");
+   MG_FTRACE("mclass_method");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "i", MG_PRODUCT);
+   mg_request_header(p_page->p_srv, p_buf, "j", MG_PRODUCT);
 
    sprintf(buffer, "%d", self->oref);
    ifc[0] = 0;
@@ -2773,9 +4320,11 @@ static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
 
    MG_MEMCHECK("Insufficient memory to process request", 1);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -2783,7 +4332,8 @@ static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -2792,7 +4342,7 @@ static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
 
       p_buf->p_buffer[p_buf->data_size] = '\0';
       oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
-      PyObject *argList = Py_BuildValue("sii", "mclass", oref, vargs.phndle);
+      PyObject *argList = Py_BuildValue("siO", "mclass", oref, vargs.handle ? vargs.handle : Py_None);
 
       /* Call the class object. */
       PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
@@ -2800,147 +4350,345 @@ static PyObject * ex_mclass_setproperty(MClassObject *self, PyObject *args)
       /* Release the argument list. */
       Py_DECREF(argList);
 
+      mg_scratch_release(&vargs.scratch); /* v2.4.50 */
+      mg_buf_release(p_page->p_srv, p_buf);
       return obj;
    }
 
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-static PyObject * ex_mclass_close(MClassObject *self, PyObject *args)
-{
-    if (self->class_name == NULL) {
-        PyErr_SetString(PyExc_AttributeError, "class_name");
-        return NULL;
-    }
-    return PyUnicode_FromFormat("*** class_name=%S ***", self->class_name);
-}
-
-
-static PyObject * ex_ma_html_ex(PyObject *self, PyObject *args)
+static PyObject * ex_mclass_getproperty(MClassObject *self, MG_FASTCALL_ARGS)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, an, t, argn, chndle, phndle, len;
-   int types[32];
-   int byrefs[32];
+   int n, max;
    int ifc[4];
-   char bstr[256], bstr1[256];
-   MGSTR properties[MG_MAX_KEY];
-   char *str;
-   char *fun;
-   PyObject *a_list;
-   PyObject *a;
-   PyObject *pstr;
-   PyObject *p;
+   int chndle;
+   char buffer[32];
    MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "isOi", &phndle, &fun, &a_list, &argn))
+   if (!self)
+      return NULL;
+   if ((max = mg_get_vargs(NULL, MG_FASTCALL_PASS, &vargs, 1)) == -1)
       return NULL;
 
-   if (mg_type(a_list) != MG_T_LIST) {
-      MG_ERROR("mg_python: Argument 3 to 'ma_html_ex' must be a list");
+   vargs.handle = self->handle;
+   p_page = mg_handle_page(self->handle);
+   if (!p_page) {
+      mg_scratch_release(&vargs.scratch);
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
-
-   MG_FTRACE("ma_html_ex");
-
-   pstr = PyList_GetItem(a_list, 0);
-   str = NULL;
-   strcpy(bstr, "");
-   strcpy(bstr1, "");
-   if (pstr)
-      str = (char *) MG_GET_PYSTRING(pstr);
-   if (str) {
-      strcpy(bstr, str);
-   }
-
-   max = mg_extract_substrings(properties, bstr, (int) strlen(bstr), '#', 0, 0, MG_ES_DELIM);
-
-   for (an = 1; an < 32; an ++) {
-      if (an < max) {
-         if (properties[an].ps[0] == '1')
-            types[an] = 1;
-         else
-            types[an] = 0;
-         if (properties[an].ps[1] == '1')
-            byrefs[an] = 1;
-         else
-            byrefs[an] = 0;
-      }
-      else {
-         types[an] = 0;
-         byrefs[an] = 0;
-      }
-   }
-
-   chndle = 0;
+   mg_buf_get(p_page->p_srv, p_buf);
 
-   max = 0;
+   MG_FTRACE("mclass_getproperty");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
-   mg_request_header(p_page->p_srv, p_buf, "H", MG_PRODUCT);
+   mg_request_header(p_page->p_srv, p_buf, "h", MG_PRODUCT);
 
+   sprintf(buffer, "%d", self->oref);
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) fun, (int) strlen((char *) fun), (short) ifc[0], (short) ifc[1]);
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) buffer, (int) strlen((char *) buffer), (short) ifc[0], (short) ifc[1]);
 
-   for (an = 1; an <= argn; an ++) {
+   for (n = 0; n < max; n ++) {
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+   }
 
-      str = NULL;
-      pstr = PyList_GetItem(a_list, an);
-      if (pstr) {
+   MG_MEMCHECK("Insufficient memory to process request", 1);
 
-         if (byrefs[an])
-            ifc[0] = 1;
-         else
-            ifc[0] = 0;
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
 
-         t = mg_type(pstr);
-         if (t == MG_T_LIST) {
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
-            int max, n;
+   MG_MEMCHECK("Insufficient memory to process response", 0);
 
-            ifc[1] = MG_TX_AREC;
-            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
 
-            ifc[1] = MG_TX_AREC_FORMATTED;
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
 
-            max = (int) PyList_Size(pstr);
-            for (n = 0; n < max; n ++) {
-               a = PyList_GetItem(pstr, n);
-               str = mg_get_string(a, &p, &len);
-               mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
-            }
+   if (!strncmp((char *) p_buf->p_buffer + 5, "co", 2)) { /* v2.4.48 */
+      int oref;
 
-            ifc[1] = MG_TX_EOD;
-            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+      p_buf->p_buffer[p_buf->data_size] = '\0';
+      oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+      PyObject *argList = Py_BuildValue("siO", "mclass", oref, vargs.handle ? vargs.handle : Py_None);
 
-         }
-         else {
-            str = mg_get_string(pstr, &p, &n);
+      /* Call the class object. */
+      PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
 
-            ifc[1] = MG_TX_DATA;
+      /* Release the argument list. */
+      Py_DECREF(argList);
 
-            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, (int) strlen((char *) str), (short) ifc[0], (short) ifc[1]);
-         }
-      }
+      mg_scratch_release(&vargs.scratch); /* v2.4.50 */
+      mg_buf_release(p_page->p_srv, p_buf);
+      return obj;
    }
 
+   output = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
+
+
+static PyObject * ex_mclass_setproperty(MClassObject *self, MG_FASTCALL_ARGS)
+{
+   MGBUF mgbuf, *p_buf;
+   int n, max;
+   int ifc[4];
+   int chndle;
+   char buffer[32];
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *output;
+
+   if (!self)
+      return NULL;
+   if ((max = mg_get_vargs(NULL, MG_FASTCALL_PASS, &vargs, 1)) == -1)
+      return NULL;
+
+   vargs.handle = self->handle;
+   p_page = mg_handle_page(self->handle);
+   if (!p_page) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+
+   MG_FTRACE("mclass_setproperty");
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   mg_request_header(p_page->p_srv, p_buf, "i", MG_PRODUCT);
+
+   sprintf(buffer, "%d", self->oref);
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) buffer, (int) strlen((char *) buffer), (short) ifc[0], (short) ifc[1]);
+
+   for (n = 0; n < max; n ++) {
+      ifc[0] = 0;
+      ifc[1] = MG_TX_DATA;
+      mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) vargs.cvars[n].ps, vargs.cvars[n].size, (short) ifc[0], (short) ifc[1]);
+   }
+
+   MG_MEMCHECK("Insufficient memory to process request", 1);
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_buf_free(p_buf);
+
+   mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
+
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   if (!strncmp((char *) p_buf->p_buffer + 5, "co", 2)) { /* v2.4.48 */
+      int oref;
+
+      p_buf->p_buffer[p_buf->data_size] = '\0';
+      oref = (int) strtol(p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+      PyObject *argList = Py_BuildValue("siO", "mclass", oref, vargs.handle ? vargs.handle : Py_None);
+
+      /* Call the class object. */
+      PyObject *obj = PyObject_CallObject((PyObject *) &MClassType, argList);
+
+      /* Release the argument list. */
+      Py_DECREF(argList);
+
+      mg_scratch_release(&vargs.scratch); /* v2.4.50 */
+      mg_buf_release(p_page->p_srv, p_buf);
+      return obj;
+   }
+
+   output = MG_MAKE_PYDATAN(mg_handle_ppage(self->handle), p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
+}
+
+
+static PyObject * ex_mclass_close(MClassObject *self, PyObject *args)
+{
+    if (self->class_name == NULL) {
+        PyErr_SetString(PyExc_AttributeError, "class_name");
+        return NULL;
+    }
+    return PyUnicode_FromFormat("*** class_name=%S ***", self->class_name);
+}
+
+
+static PyObject * ex_ma_html_ex(PyObject *self, PyObject *args)
+{
+   MGBUF mgbuf, *p_buf;
+   int n, max, an, t, argn, chndle, len;
+   int types[32];
+   int byrefs[32];
+   int ifc[4];
+   char bstr[256], bstr1[256];
+   MGSTR properties[MG_MAX_KEY];
+   char *str;
+   char *fun;
+   PyObject *a_list;
+   PyObject *a;
+   PyObject *pstr;
+   MGPAGE *p_page;
+   MGSCRATCH scratch;
+
+   if (!PyArg_ParseTuple(args, "O&sOi", mg_get_page, &p_page, &fun, &a_list, &argn))
+      return NULL;
+
+   if (mg_type(a_list) != MG_T_LIST) {
+      MG_ERROR("mg_python: Argument 3 to 'ma_html_ex' must be a list");
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
+
+   MG_FTRACE("ma_html_ex");
+
+   pstr = PyList_GetItem(a_list, 0);
+   str = NULL;
+   strcpy(bstr, "");
+   strcpy(bstr1, "");
+   if (pstr)
+      str = (char *) MG_GET_PYSTRING(pstr);
+   if (str) {
+      strcpy(bstr, str);
+   }
+
+   max = mg_extract_substrings(properties, bstr, (int) strlen(bstr), '#', 0, 0, MG_ES_DELIM);
+
+   for (an = 1; an < 32; an ++) {
+      if (an < max) {
+         if (properties[an].ps[0] == '1')
+            types[an] = 1;
+         else
+            types[an] = 0;
+         if (properties[an].ps[1] == '1')
+            byrefs[an] = 1;
+         else
+            byrefs[an] = 0;
+      }
+      else {
+         types[an] = 0;
+         byrefs[an] = 0;
+      }
+   }
+
+   chndle = 0;
+
+   max = 0;
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   mg_request_header(p_page->p_srv, p_buf, "H", MG_PRODUCT);
+
+   ifc[0] = 0;
+   ifc[1] = MG_TX_DATA;
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) fun, (int) strlen((char *) fun), (short) ifc[0], (short) ifc[1]);
+
+   for (an = 1; an <= argn; an ++) {
+
+      str = NULL;
+      pstr = PyList_GetItem(a_list, an);
+      if (pstr) {
+
+         if (byrefs[an])
+            ifc[0] = 1;
+         else
+            ifc[0] = 0;
+
+         t = mg_type(pstr);
+         if (t == MG_T_LIST) {
+
+            int max, n;
+
+            ifc[1] = MG_TX_AREC;
+            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+            ifc[1] = MG_TX_AREC_FORMATTED;
+
+            max = (int) PyList_Size(pstr);
+            for (n = 0; n < max; n ++) {
+               a = PyList_GetItem(pstr, n);
+               str = mg_get_string(a, &scratch, &len);
+               mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
+            }
+
+            ifc[1] = MG_TX_EOD;
+            mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
+
+         }
+         else {
+            str = mg_get_string(pstr, &scratch, &n);
+
+            ifc[1] = MG_TX_DATA;
+
+            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, n, (short) ifc[0], (short) ifc[1]);
+         }
+      }
+   }
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+   MG_END_ALLOW_THREADS;
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return Py_BuildValue("i", chndle);
 }
 
@@ -2948,7 +4696,7 @@ static PyObject * ex_ma_html_ex(PyObject *self, PyObject *args)
 static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, an, t, argn, chndle, phndle, len;
+   int n, max, an, t, argn, chndle, len;
    int types[32];
    int byrefs[32];
    int ifc[4];
@@ -2960,10 +4708,10 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
    PyObject *a_list;
    PyObject *a;
    PyObject *pstr;
-   PyObject *p;
    MGPAGE *p_page;
+   MGSCRATCH scratch;
 
-   if (!PyArg_ParseTuple(args, "issOi", &phndle, &cclass, &cmethod, &a_list, &argn))
+   if (!PyArg_ParseTuple(args, "O&ssOi", mg_get_page, &p_page, &cclass, &cmethod, &a_list, &argn))
       return NULL;
 
    if (mg_type(a_list) != MG_T_LIST) {
@@ -2971,10 +4719,9 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_html_classmethod_ex");
 
@@ -3011,10 +4758,13 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
 
    max = 0;
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -3052,7 +4802,7 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
             max = (int) PyList_Size(pstr);
             for (n = 0; n < max; n ++) {
                a = PyList_GetItem(pstr, n);
-               str = mg_get_string(a, &p, &len);
+               str = mg_get_string(a, &scratch, &len);
                mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
             }
 
@@ -3061,17 +4811,20 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
 
          }
          else {
-            str = mg_get_string(pstr, &p, &n);
+            str = mg_get_string(pstr, &scratch, &n);
 
             ifc[1] = MG_TX_DATA;
 
-            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, (int) strlen((char *) str), (short) ifc[0], (short) ifc[1]);
+            mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, n, (short) ifc[0], (short) ifc[1]);
          }
       }
    }
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_buf_free(p_buf);
+   MG_END_ALLOW_THREADS;
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return Py_BuildValue("i", chndle);
 }
 
@@ -3079,16 +4832,16 @@ static PyObject * ex_ma_html_classmethod_ex(PyObject *self, PyObject *args)
 static PyObject * ex_ma_http_ex(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, chndle, phndle, len;
+   int n, max, chndle, len;
    int ifc[4];
    char *str;
    PyObject *a;
    PyObject *py_cgi;
    PyObject *py_content;
-   PyObject *p;
    MGPAGE *p_page;
+   MGSCRATCH scratch;
 
-   if (!PyArg_ParseTuple(args, "iOO", &phndle, &py_cgi, &py_content))
+   if (!PyArg_ParseTuple(args, "O&OO", mg_get_page, &p_page, &py_cgi, &py_content))
       return NULL;
 
    if (mg_type(py_cgi) != MG_T_LIST) {
@@ -3096,10 +4849,9 @@ static PyObject * ex_ma_http_ex(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_http_ex");
 
@@ -3107,10 +4859,13 @@ static PyObject * ex_ma_http_ex(PyObject *self, PyObject *args)
 
    max = 0;
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -3126,37 +4881,41 @@ static PyObject * ex_ma_http_ex(PyObject *self, PyObject *args)
 
    for (n = 0; n < max; n ++) {
       a = PyList_GetItem(py_cgi, n);
-      str = mg_get_string(a, &p, &len);
+      str = mg_get_string(a, &scratch, &len);
       mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
    }
    ifc[1] = MG_TX_EOD;
    mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
 
-   str = mg_get_string(py_content, &p, &n);
+   str = mg_get_string(py_content, &scratch, &n);
 
    ifc[0] = 0;
    ifc[1] = MG_TX_DATA;
-   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, (int) strlen((char *) str), (short) ifc[0], (short) ifc[1]);
+   mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, n, (short) ifc[0], (short) ifc[1]);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
-   mg_buf_free(p_buf);
+   MG_END_ALLOW_THREADS;
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return Py_BuildValue("i", chndle);
 }
 
 
 static PyObject * ex_ma_arg_set(PyObject *self, PyObject *args)
 {
-   int n, max, t, argn, by_ref, typ, phndle;
+   int n, max, t, argn, by_ref, typ;
    char buffer[MG_BUFSIZE], error[256], props[256], bstr[256], bstr1[256];
    MGSTR properties[MG_MAX_KEY];
    char *str;
    PyObject *a_list;
    PyObject *a;
    PyObject *pstr;
+   MGPAGE *p_page;
 
    *props = '\0';
 
-   if (!PyArg_ParseTuple(args, "iOiOi", &phndle, &a_list, &argn, &a, &by_ref))
+   if (!PyArg_ParseTuple(args, "O&OiOi", mg_get_page, &p_page, &a_list, &argn, &a, &by_ref))
       return NULL;
 
 
@@ -3219,6 +4978,7 @@ static PyObject * ex_ma_arg_set(PyObject *self, PyObject *args)
 
    pstr = MG_MAKE_PYSTRING(bstr1);
    mg_set_list_item(a_list, 0, pstr);
+   Py_INCREF(a);
    mg_set_list_item(a_list, argn, a);
 
    /* printf("cmcmcm: this will crash\n"); */
@@ -3233,12 +4993,12 @@ static PyObject * ex_ma_arg_set(PyObject *self, PyObject *args)
 static PyObject * ex_ma_get_stream_data(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, phndle, chndle;
+   int n, chndle;
    PyObject *py_chndle;
    MGPAGE *p_page;
    PyObject *output;
 
-   if (!PyArg_ParseTuple(args, "iO", &phndle, &py_chndle))
+   if (!PyArg_ParseTuple(args, "O&O", mg_get_page, &p_page, &py_chndle))
       return NULL;
 
    chndle = mg_get_integer(py_chndle);
@@ -3248,30 +5008,30 @@ static PyObject * ex_ma_get_stream_data(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = tp_page[phndle];
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
 
    MG_FTRACE("ma_get_stream_data");
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    if (n < 1) {
       strcpy((char *) p_buf->p_buffer, "");
       mg_db_disconnect(p_page->p_srv, chndle, 0);
       output = Py_BuildValue("s", p_buf->p_buffer);
-      mg_buf_free(p_buf);
+      mg_buf_release(p_page->p_srv, p_buf);
       return output;
    }
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
-   output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
@@ -3280,15 +5040,17 @@ static PyObject * ex_ma_get_stream_data(PyObject *self, PyObject *args)
 static PyObject * ex_ma_return_to_client(PyObject *self, PyObject *args)
 {
    char record[MG_BUFSIZE];
-   int phndle, len;
+   int len;
    PyObject *py_data;
-   PyObject *p;
    char *ps;
+   MGSCRATCH scratch;
+   MGPAGE *p_page;
 
-   if (!PyArg_ParseTuple(args, "iO", &phndle, &py_data))
+   if (!PyArg_ParseTuple(args, "O&O", mg_get_page, &p_page, &py_data))
       return NULL;
 
-   ps = mg_get_string(py_data, &p, &len);
+   mg_scratch_init(&scratch);
+   ps = mg_get_string(py_data, &scratch, &len);
 
    strcpy(record, "\x07");
    if (ps) {
@@ -3297,6 +5059,7 @@ static PyObject * ex_ma_return_to_client(PyObject *self, PyObject *args)
    }
    else
       len = 1;
+   mg_scratch_release(&scratch);
 
    return MG_MAKE_PYSTRINGN(record, len);
 
@@ -3306,27 +5069,29 @@ static PyObject * ex_ma_return_to_client(PyObject *self, PyObject *args)
 
 static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
 {
-   int result, index, max, mrec, rmax, start, found, rn, phndle, n, len;
+   int result, index, max, mrec, rmax, start, found, rn, n, len;
    char buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_record;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *data;
    PyObject *p;
-   PyObject *temp;
    char * ps;
    MGBUF mgbuf, *p_buf;
    PyObject *output;
+   MGPAGE *p_page;
 
    rmax = 0;
 
    p_buf = &mgbuf;
    mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_scratch_init(&scratch);
 
-   if (!PyArg_ParseTuple(args, "iOOOO", &phndle, &records, &py_index, &key, &data)) {
+   if (!PyArg_ParseTuple(args, "O&OOOO", mg_get_page, &p_page, &records, &py_index, &key, &data)) {
+      mg_scratch_release(&scratch);
       mg_buf_free(p_buf);
       return NULL;
    }
@@ -3335,20 +5100,22 @@ static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
 
    if (mg_type(records) != MG_T_LIST) {
       MG_ERROR("mg_python: Argument 2 to 'ma_local_set' must be a list");
+      mg_scratch_release(&scratch);
       mg_buf_free(p_buf);
       return NULL;
    }
    if (mg_type(key) != MG_T_LIST) {
       MG_ERROR("mg_python: Argument 4 to 'ma_local_set' must be a list");
+      mg_scratch_release(&scratch);
       mg_buf_free(p_buf);
       return NULL;
    }
 
    mrec = (int) PyList_Size(records);
 
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
-   ps = mg_get_string(data, &p, &len);
+   ps = mg_get_string(data, &scratch, &len);
 
    for (n = 1; n <= max; n ++) {
       mg_request_add(NULL, -1, p_buf, (unsigned char *) nkey[n].ps, nkey[n].size, 0, MG_TX_AKEY);
@@ -3359,6 +5126,7 @@ static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
 
    if (index == -2) {
       PyList_Append(records,  py_record);
+      Py_DECREF(py_record);
    }
    else if (index > -1) {
       mg_set_list_item(records, index, py_record);
@@ -3369,7 +5137,7 @@ static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
 
       for (rn = start; rn < mrec; rn ++) {
          p = PyList_GetItem(records, rn);
-         ps = mg_get_string(p, &temp, &len);
+         ps = mg_get_string(p, &scratch, &len);
          memcpy((void *) buffer, (void *) ps, len);
          rmax = mg_extract_substrings(rkey, buffer, len, '#', 1, 0, MG_ES_BLOCK);
          rmax --;
@@ -3389,6 +5157,7 @@ static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
    result = rmax;
 
    output = MG_MAKE_PYSTRINGN(p_buf->p_buffer, p_buf->data_size);
+   mg_scratch_release(&scratch);
    mg_buf_free(p_buf);
    return output;
 }
@@ -3396,17 +5165,17 @@ static PyObject * ex_ma_local_set(PyObject *self, PyObject *args)
 
 static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
 {
-   int index, max, mrec, rmax, start, rn, phndle, len;
+   int index, max, mrec, rmax, start, rn, len;
    char record[MG_BUFSIZE], buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *p;
-   PyObject *temp;
    char * ps;
    char * result;
+   MGPAGE *p_page;
 
    rmax = 0;
 
@@ -3414,7 +5183,7 @@ static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
    strcpy(record, "");
    len = 0;
 
-   if (!PyArg_ParseTuple(args, "iOOO", &phndle, &records, &py_index, &key))
+   if (!PyArg_ParseTuple(args, "O&OOO", mg_get_page, &p_page, &records, &py_index, &key))
       return NULL;
 
    index = mg_get_integer(py_index);
@@ -3429,12 +5198,13 @@ static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
    }
 
    mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   mg_scratch_init(&scratch);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    if (index > -1) {
       if (index < mrec) {
          p = PyList_GetItem(records, index);
-         ps = mg_get_string(p, &temp, &len);
+         ps = mg_get_string(p, &scratch, &len);
          memcpy((void *) buffer, (void *) ps, len);
          rmax = mg_extract_substrings(rkey, buffer, (int) strlen(buffer), '#', 1, 0, MG_ES_BLOCK);
          result = (char *) rkey[rmax].ps;
@@ -3445,7 +5215,7 @@ static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
       start = 0;
       for (rn = start; rn < mrec; rn ++) {
          p = PyList_GetItem(records, rn);
-         ps = mg_get_string(p, &temp, &len);
+         ps = mg_get_string(p, &scratch, &len);
          memcpy((void *) buffer, (void *) ps, len);
          rmax = mg_extract_substrings(rkey, buffer, len, '#', 1, 0, MG_ES_BLOCK);
          rmax --;
@@ -3460,6 +5230,7 @@ static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
    }
 
 
+   mg_scratch_release(&scratch);
    return MG_MAKE_PYSTRINGN(result, len);
 
 }
@@ -3467,21 +5238,21 @@ static PyObject * ex_ma_local_get(PyObject *self, PyObject *args)
 
 static PyObject * ex_ma_local_data(PyObject *self, PyObject *args)
 {
-   int result, index, max, mrec, rmax, start, rn, data, subs, phndle, len;
+   int result, index, max, mrec, rmax, start, rn, data, subs, len;
    char buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *p;
-   PyObject *temp;
    char * ps;
+   MGPAGE *p_page;
 
    result = 0;
    rmax = 0;
 
-   if (!PyArg_ParseTuple(args, "iOOO", &phndle, &records, &py_index, &key))
+   if (!PyArg_ParseTuple(args, "O&OOO", mg_get_page, &p_page, &records, &py_index, &key))
       return NULL;
 
    index = mg_get_integer(py_index);
@@ -3496,7 +5267,8 @@ static PyObject * ex_ma_local_data(PyObject *self, PyObject *args)
    }
 
    mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   mg_scratch_init(&scratch);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    result = 0;
    if (index > -1) {
@@ -3510,7 +5282,7 @@ static PyObject * ex_ma_local_data(PyObject *self, PyObject *args)
       subs = 0;
       for (rn = start; rn < mrec; rn ++) {
          p = PyList_GetItem(records, rn);
-         ps = mg_get_string(p, &temp, &len);
+         ps = mg_get_string(p, &scratch, &len);
          memcpy((void *) buffer, (void *) ps, len);
          rmax = mg_extract_substrings(rkey, buffer, (int) strlen(buffer), '#', 1, 0, MG_ES_BLOCK);
          rmax --;
@@ -3528,27 +5300,28 @@ static PyObject * ex_ma_local_data(PyObject *self, PyObject *args)
       result = data + subs;
    }
 
+   mg_scratch_release(&scratch);
    return Py_BuildValue("i", result);
 }
 
 
 static PyObject * ex_ma_local_kill(PyObject *self, PyObject *args)
 {
-   int result, index, max, mrec, rmax, start, rn, phndle, len;
+   int result, index, max, mrec, rmax, start, rn, len;
    char buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *p;
-   PyObject *temp;
    char * ps;
+   MGPAGE *p_page;
 
    rmax = 0;
    result = 0;
 
-   if (!PyArg_ParseTuple(args, "iOOO", &phndle, &records, &py_index, &key))
+   if (!PyArg_ParseTuple(args, "O&OOO", mg_get_page, &p_page, &records, &py_index, &key))
       return NULL;
 
    index = mg_get_integer(py_index);
@@ -3563,7 +5336,8 @@ static PyObject * ex_ma_local_kill(PyObject *self, PyObject *args)
    }
 
    mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   mg_scratch_init(&scratch);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
 
    if (index > -1) {
       if (index < mrec) {
@@ -3575,7 +5349,7 @@ static PyObject * ex_ma_local_kill(PyObject *self, PyObject *args)
       start = 0;
       for (rn = start; rn < mrec; rn ++) {
          p = PyList_GetItem(records, rn);
-         ps = mg_get_string(p, &temp, &len);
+         ps = mg_get_string(p, &scratch, &len);
          memcpy((void *) buffer, (void *) ps, len);
          rmax = mg_extract_substrings(rkey, buffer, len, '#', 1, 0, MG_ES_BLOCK);
          rmax --;
@@ -3588,23 +5362,24 @@ static PyObject * ex_ma_local_kill(PyObject *self, PyObject *args)
       }
    }
 
+   mg_scratch_release(&scratch);
    return Py_BuildValue("i", result);
 }
 
 
 static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
 {
-   int result, index, max, mrec, rmax, start, rn, found, next, phndle, len;
+   int result, index, max, mrec, rmax, start, rn, found, next, len;
    char buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *p;
-   PyObject *temp;
    char *vkey, *vrkey, *vrkey1;
    char * ps;
+   MGPAGE *p_page;
 
    rmax = 0;
    result = -1;
@@ -3612,7 +5387,7 @@ static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
    vrkey = NULL;
    vrkey1 = NULL;
 
-   if (!PyArg_ParseTuple(args, "iOOO", &phndle, &records, &py_index, &key))
+   if (!PyArg_ParseTuple(args, "O&OOO", mg_get_page, &p_page, &records, &py_index, &key))
       return NULL;
 
    index = mg_get_integer(py_index);
@@ -3627,7 +5402,8 @@ static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
    }
 
    mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   mg_scratch_init(&scratch);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
    vkey = (char *) nkey[max].ps;
 
    start = 0;
@@ -3641,7 +5417,7 @@ static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
 
    for (rn = start; rn < mrec; rn ++) {
       p = PyList_GetItem(records, rn);
-      ps = mg_get_string(p, &temp, &len);
+      ps = mg_get_string(p, &scratch, &len);
       memcpy((void *) buffer, (void *) ps, len);
       rmax = mg_extract_substrings(rkey, buffer, len, '#', 1, 0, MG_ES_BLOCK);
       rmax --;
@@ -3685,6 +5461,7 @@ static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
       mg_set_list_item(key, max, p);
    }
 
+   mg_scratch_release(&scratch);
    return Py_BuildValue("i", result);
 }
 
@@ -3692,17 +5469,17 @@ static PyObject * ex_ma_local_order(PyObject *self, PyObject *args)
 
 static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
 {
-   int result, index, max, mrec, rmax, start, rn, found, next, phndle, len;
+   int result, index, max, mrec, rmax, start, rn, found, next, len;
    char buffer[MG_BUFSIZE];
    MGSTR rkey[MG_MAX_KEY], nkey[MG_MAX_KEY];
-   PyObject *py_nkey[MG_MAX_KEY];
+   MGSCRATCH scratch;
    PyObject *py_index;
    PyObject *records;
    PyObject *key;
    PyObject *p;
-   PyObject *temp;
    char *vkey, *vrkey, *vrkey1;
    char * ps;
+   MGPAGE *p_page;
 
    rmax = 0;
    result = -1;
@@ -3710,7 +5487,7 @@ static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
    vrkey = NULL;
    vrkey1 = NULL;
 
-   if (!PyArg_ParseTuple(args, "iOOO", &phndle, &records, &py_index, &key))
+   if (!PyArg_ParseTuple(args, "O&OOO", mg_get_page, &p_page, &records, &py_index, &key))
       return NULL;
 
    index = mg_get_integer(py_index);
@@ -3725,7 +5502,8 @@ static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
    }
 
    mrec = (int) PyList_Size(records);
-   max = mg_get_keys(key, nkey, py_nkey, NULL);
+   mg_scratch_init(&scratch);
+   max = mg_get_keys(key, nkey, &scratch, NULL);
    vkey = (char *) nkey[max].ps;
 
    start = 0;
@@ -3739,7 +5517,7 @@ static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
 
    for (rn = index; rn >= start; rn --) {
       p = PyList_GetItem(records, rn);
-      ps = mg_get_string(p, &temp, &len);
+      ps = mg_get_string(p, &scratch, &len);
       memcpy((void *) buffer, (void *) ps, len);
       rmax = mg_extract_substrings(rkey, buffer, len, '#', 1, 0, MG_ES_BLOCK);
       rmax --;
@@ -3782,6 +5560,7 @@ static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
       mg_set_list_item(key, max, p);
    }
 
+   mg_scratch_release(&scratch);
    return Py_BuildValue("i", result);
 }
 
@@ -3789,7 +5568,7 @@ static PyObject * ex_ma_local_previous(PyObject *self, PyObject *args)
 static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
 {
    MGBUF mgbuf, *p_buf;
-   int n, max, chndle, phndle, anybyref, len;
+   int n, max, chndle, anybyref, len;
    int ifc[4];
    char buffer[MG_BUFSIZE];
    char *str;
@@ -3798,8 +5577,9 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
    PyObject *p;
    MGPAGE *p_page;
    PyObject *output;
+   MGSCRATCH scratch;
 
-   if (!PyArg_ParseTuple(args, "iO", &phndle, &records))
+   if (!PyArg_ParseTuple(args, "O&O", mg_get_page, &p_page, &records))
       return NULL;
 
    if (mg_type(records) != MG_T_LIST) {
@@ -3807,10 +5587,9 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
       return NULL;
    }
 
-   p_page = mg_ppage(phndle);
-
    p_buf = &mgbuf;
-   mg_buf_init(p_buf, MG_BUFSIZE, MG_BUFSIZE);
+   mg_buf_get(p_page->p_srv, p_buf);
+   mg_scratch_init(&scratch);
 
    MG_FTRACE("ma_local_sort");
 
@@ -3818,10 +5597,13 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
    max = 0;
    anybyref = 1;
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
    if (!n) {
       MG_ERROR(p_page->p_srv->error_mess);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -3842,14 +5624,16 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
    max = (int) PyList_Size(records);
    for (n = 0; n < max; n ++) {
       a = PyList_GetItem(records, n);
-      str = mg_get_string(a, &p, &len);
+      str = mg_get_string(a, &scratch, &len);
       mg_request_add(p_page->p_srv, chndle, p_buf, (unsigned char *) str, len, (short) ifc[0], (short) ifc[1]);
    }
    ifc[1] = MG_TX_EOD;
    mg_request_add(p_page->p_srv, chndle, p_buf, NULL, 0, (short) ifc[0], (short) ifc[1]);
 
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
    mg_db_send(p_page->p_srv, chndle, p_buf, 1);
    mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   MG_END_ALLOW_THREADS;
 
    MG_MEMCHECK("Insufficient memory to process response", 0);
 
@@ -3857,7 +5641,8 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
 
    if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
       MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
-      mg_buf_free(p_buf);
+      mg_scratch_release(&scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
       return NULL;
    }
 
@@ -3927,48 +5712,214 @@ static PyObject * ex_ma_local_sort(PyObject *self, PyObject *args)
       }
    }
    output = MG_MAKE_PYSTRINGN(p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
-   mg_buf_free(p_buf);
+   mg_scratch_release(&scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
    return output;
 }
 
 
-/* v2.4.48 */
-static PyMethodDef mg_python_methods[] = {
-	{"m_ext_version", ex_m_ext_version, METH_VARARGS, "m_ext_version() doc string"},
+/* v2.4.50: Connection objects own their page rather than taking one from tp_page[] */
+static PyObject * ex_mconnection_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+   MConnectionObject *self;
 
-	{"m_allocate_page_handle", ex_m_allocate_page_handle, METH_VARARGS, "m_allocate_page_handle() doc string"},
-	{"m_release_page_handle", ex_m_release_page_handle, METH_VARARGS, "m_release_page_handle() doc string"},
-	{"m_set_storage_mode", ex_m_set_storage_mode, METH_VARARGS, "m_set_storage_mode() doc string"},
+   self = (MConnectionObject *) type->tp_alloc(type, 0);
+   if (!self) {
+      return NULL;
+   }
 
-	{"m_set_host", ex_m_set_host, METH_VARARGS, "m_set_host() doc string"},
-	{"m_set_uci", ex_m_set_uci, METH_VARARGS, "m_set_uci() doc string"},
-	{"m_set_server", ex_m_set_server, METH_VARARGS, "m_set_server() doc string"},
-	{"m_set_timeout", ex_m_set_timeout, METH_VARARGS, "m_set_timeout() doc string"},
+   self->closed = 0;
+   self->p_page = (MGPAGE *) mg_malloc(sizeof(MGPAGE), 0);
+   if (!self->p_page) {
+      Py_DECREF(self);
+      MG_ERROR("Insufficient memory to process request");
+      return NULL;
+   }
+   mg_ppage_init(self->p_page);
 
-	{"m_bind_server_api", ex_m_bind_server_api, METH_VARARGS, "m_bind_server_api() doc string"},
-	{"m_release_server_api", ex_m_release_server_api, METH_VARARGS, "m_release_server_api() doc string"},
+   return (PyObject *) self;
+}
 
-	{"m_get_last_error", ex_m_get_last_error, METH_VARARGS, "m_get_last_error() doc string"},
 
-   {"m_set", ex_m_set, METH_VARARGS, "m_set() doc string"},
-   {"ma_set", ex_ma_set, METH_VARARGS, "ma_set() doc string"},
-	{"m_get", ex_m_get, METH_VARARGS, "m_get() doc string"},
-	{"ma_get", ex_ma_get, METH_VARARGS, "ma_get() doc string"},
-	{"m_kill", ex_m_kill, METH_VARARGS, "m_kill() doc string"},
-	{"ma_kill", ex_ma_kill, METH_VARARGS, "ma_kill() doc string"},
-	{"m_delete", ex_m_kill, METH_VARARGS, "m_delete() doc string"},
-	{"ma_delete", ex_ma_kill, METH_VARARGS, "ma_delete() doc string"},
-	{"m_data", ex_m_data, METH_VARARGS, "m_data() doc string"},
-	{"ma_data", ex_ma_data, METH_VARARGS, "ma_data() doc string"},
-	{"m_defined", ex_m_data, METH_VARARGS, "m_defined() doc string"},
-	{"ma_defined", ex_ma_data, METH_VARARGS, "ma_defined() doc string"},
-	{"m_order", ex_m_order, METH_VARARGS, "m_order() doc string"},
-	{"ma_order", ex_ma_order, METH_VARARGS, "ma_order() doc string"},
-	{"m_previous", ex_m_previous, METH_VARARGS, "m_previous() doc string"},
-	{"ma_previous", ex_ma_previous, METH_VARARGS, "ma_previous() doc string"},
+/* Connection([host=<host>] [, port=<port>] [, username=<username>] [, password=<password>] [, uci=<uci>]) */
+static int ex_mconnection_init(MConnectionObject *self, PyObject *args, PyObject *kwds)
+{
+   static char *kwlist[] = {"host", "port", "username", "password", "uci", NULL};
+   int port;
+   char *host, *username, *password, *uci;
+
+   host = NULL;
+   port = self->p_page->p_srv->port;
+   username = NULL;
+   password = NULL;
+   uci = NULL;
+
+   if (!PyArg_ParseTupleAndKeywords(args, kwds, "|sisss", kwlist, &host, &port, &username, &password, &uci))
+      return -1;
+
+   if (host && !mg_ppage_host(self->p_page, host, port, username, password)) {
+      MG_ERROR("mg_python: Connection: the host name is too long");
+      return -1;
+   }
+   if (uci) {
+      if (strlen(uci) >= sizeof(self->p_page->p_srv->uci)) {
+         MG_ERROR("mg_python: Connection: the UCI name is too long");
+         return -1;
+      }
+      strcpy(self->p_page->p_srv->uci, uci);
+   }
+
+   return 0;
+}
+
+
+static void ex_mconnection_dealloc(MConnectionObject *self)
+{
+   if (self->p_page) {
+      mg_ppage_free(self->p_page);
+   }
+   Py_TYPE(self)->tp_free((PyObject *) self);
+}
+
+
+/* Release the connections to the DB Server and the buffers held: the page itself is kept until the Connection is freed, since iterators and mglobal objects may still refer to it */
+static PyObject * ex_mconnection_close(MConnectionObject *self, PyObject *args)
+{
+   int result;
+
+   result = 0;
+   if (!self->closed) {
+      self->closed = 1;
+      mg_ppage_close(self->p_page);
+      result = 1;
+   }
+
+   return Py_BuildValue("i", result);
+}
+
+
+static PyObject * ex_mconnection_enter(MConnectionObject *self, PyObject *args)
+{
+   if (self->closed) {
+      MG_ERROR("mg_python: The connection is closed");
+      return NULL;
+   }
+
+   Py_INCREF(self);
+   return (PyObject *) self;
+}
+
+
+static PyObject * ex_mconnection_exit(MConnectionObject *self, PyObject *args)
+{
+   if (!self->closed) {
+      self->closed = 1;
+      mg_ppage_close(self->p_page);
+   }
+
+   Py_INCREF(Py_False);
+   return Py_False;
+}
+
+
+/* The global functions are shared with the module: they take the database handle from self when it is a Connection */
+static PyMethodDef mconnection_methods[] = {
+   {"set", MG_FASTCALL(ex_m_set), MG_METH_FASTCALL, "Set a global node"},
+   {"get", MG_FASTCALL(ex_m_get), MG_METH_FASTCALL, "Get a global node"},
+   {"kill", MG_FASTCALL(ex_m_kill), MG_METH_FASTCALL, "Delete a global node and the nodes below it"},
+   {"delete", MG_FASTCALL(ex_m_kill), MG_METH_FASTCALL, "Delete a global node and the nodes below it"},
+   {"data", MG_FASTCALL(ex_m_data), MG_METH_FASTCALL, "$Data of a global node"},
+   {"defined", MG_FASTCALL(ex_m_data), MG_METH_FASTCALL, "$Data of a global node"},
+   {"order", MG_FASTCALL(ex_m_order), MG_METH_FASTCALL, "Next subscript ($Order)"},
+   {"previous", MG_FASTCALL(ex_m_previous), MG_METH_FASTCALL, "Previous subscript ($Order(,-1))"},
+   {"order_data", MG_FASTCALL(ex_m_order_data), MG_METH_FASTCALL, "Next subscript and its data"},
+   {"previous_data", MG_FASTCALL(ex_m_previous_data), MG_METH_FASTCALL, "Previous subscript and its data"},
+   {"increment", MG_FASTCALL(ex_m_increment), MG_METH_FASTCALL, "Increment a global node ($Increment)"},
+   {"function", MG_FASTCALL(ex_m_function), MG_METH_FASTCALL, "Invoke an M function"},
+   {"proc", MG_FASTCALL(ex_m_function), MG_METH_FASTCALL, "Invoke an M function"},
+   {"classmethod", MG_FASTCALL(ex_m_classmethod), MG_METH_FASTCALL, "Invoke InterSystems class method"},
+   {"iterate", (PyCFunction) (void (*) (void)) ex_m_iterate, METH_VARARGS | METH_KEYWORDS, "Iterate over the (key, value) pairs below a global node"},
+   {"query", (PyCFunction) (void (*) (void)) ex_m_query, METH_VARARGS | METH_KEYWORDS, "Iterate over all the nodes below a global node ($Query)"},
+   {"global_", MG_FASTCALL(ex_m_global), MG_METH_FASTCALL, "A mglobal object for a global node"},
+   {"batch", ex_m_batch, METH_VARARGS, "Process a batch of commands"},
+   {"tstart", ex_m_tstart, METH_VARARGS, "Start a transaction"},
+   {"tlevel", ex_m_tlevel, METH_VARARGS, "Transaction level"},
+   {"tcommit", ex_m_tcommit, METH_VARARGS, "Commit a transaction"},
+   {"trollback", ex_m_trollback, METH_VARARGS, "Rollback a transaction"},
+   {"close", (PyCFunction) ex_mconnection_close, METH_NOARGS, "Close the connection"},
+   {"__enter__", (PyCFunction) ex_mconnection_enter, METH_NOARGS, "Use the connection in a with statement"},
+   {"__exit__", (PyCFunction) ex_mconnection_exit, METH_VARARGS, "Close the connection on leaving a with statement"},
+   {NULL}  /* Sentinel */
+};
+
+
+static PyTypeObject MConnectionType = {
+   PyVarObject_HEAD_INIT(NULL, 0)
+   .tp_name = "mg_python.Connection",
+   .tp_doc = "A connection to a DB Server with its own settings, buffers and connection pool",
+   .tp_basicsize = sizeof(MConnectionObject),
+   .tp_itemsize = 0,
+   .tp_flags = Py_TPFLAGS_DEFAULT,
+   .tp_new = ex_mconnection_new,
+   .tp_init = (initproc) ex_mconnection_init,
+   .tp_dealloc = (destructor) ex_mconnection_dealloc,
+   .tp_methods = mconnection_methods,
+};
+
+
+/* v2.4.48 */
+static PyMethodDef mg_python_methods[] = {
+	{"m_ext_version", ex_m_ext_version, METH_VARARGS, "m_ext_version() doc string"},
+
+	{"m_allocate_page_handle", ex_m_allocate_page_handle, METH_VARARGS, "m_allocate_page_handle() doc string"},
+	{"m_release_page_handle", ex_m_release_page_handle, METH_VARARGS, "m_release_page_handle() doc string"},
+	{"m_set_storage_mode", ex_m_set_storage_mode, METH_VARARGS, "m_set_storage_mode() doc string"},
+
+	{"m_set_host", ex_m_set_host, METH_VARARGS, "m_set_host() doc string"},
+	{"m_set_uci", ex_m_set_uci, METH_VARARGS, "m_set_uci() doc string"},
+	{"m_set_server", ex_m_set_server, METH_VARARGS, "m_set_server() doc string"},
+	{"m_set_timeout", ex_m_set_timeout, METH_VARARGS, "m_set_timeout() doc string"},
+	{"m_set_buffer_policy", ex_m_set_buffer_policy, METH_VARARGS, "m_set_buffer_policy() doc string"},
+	{"m_set_connection_pool", ex_m_set_connection_pool, METH_VARARGS, "m_set_connection_pool() doc string"},
+	{"m_pool_warm", ex_m_pool_warm, METH_VARARGS, "m_pool_warm() doc string"},
+	{"m_set_health_check", ex_m_set_health_check, METH_VARARGS, "m_set_health_check() doc string"},
+	{"m_set_receive_spin", ex_m_set_receive_spin, METH_VARARGS, "m_set_receive_spin() doc string"},
+	{"m_set_bytes_mode", ex_m_set_bytes_mode, METH_VARARGS, "m_set_bytes_mode() doc string"},
+	{"m_set_number_mode", ex_m_set_number_mode, METH_VARARGS, "m_set_number_mode() doc string"},
+
+	{"m_bind_server_api", ex_m_bind_server_api, METH_VARARGS, "m_bind_server_api() doc string"},
+	{"m_release_server_api", ex_m_release_server_api, METH_VARARGS, "m_release_server_api() doc string"},
+
+	{"m_get_last_error", ex_m_get_last_error, METH_VARARGS, "m_get_last_error() doc string"},
+
+   {"m_set", MG_FASTCALL(ex_m_set), MG_METH_FASTCALL, "m_set() doc string"},
+   {"ma_set", ex_ma_set, METH_VARARGS, "ma_set() doc string"},
+	{"m_get", MG_FASTCALL(ex_m_get), MG_METH_FASTCALL, "m_get() doc string"},
+	{"ma_get", ex_ma_get, METH_VARARGS, "ma_get() doc string"},
+	{"m_kill", MG_FASTCALL(ex_m_kill), MG_METH_FASTCALL, "m_kill() doc string"},
+	{"ma_kill", ex_ma_kill, METH_VARARGS, "ma_kill() doc string"},
+	{"m_delete", MG_FASTCALL(ex_m_kill), MG_METH_FASTCALL, "m_delete() doc string"},
+	{"ma_delete", ex_ma_kill, METH_VARARGS, "ma_delete() doc string"},
+	{"m_data", MG_FASTCALL(ex_m_data), MG_METH_FASTCALL, "m_data() doc string"},
+	{"ma_data", ex_ma_data, METH_VARARGS, "ma_data() doc string"},
+	{"m_defined", MG_FASTCALL(ex_m_data), MG_METH_FASTCALL, "m_defined() doc string"},
+	{"ma_defined", ex_ma_data, METH_VARARGS, "ma_defined() doc string"},
+	{"m_order", MG_FASTCALL(ex_m_order), MG_METH_FASTCALL, "m_order() doc string"},
+	{"ma_order", ex_ma_order, METH_VARARGS, "ma_order() doc string"},
+	{"m_previous", MG_FASTCALL(ex_m_previous), MG_METH_FASTCALL, "m_previous() doc string"},
+	{"m_order_data", MG_FASTCALL(ex_m_order_data), MG_METH_FASTCALL, "m_order_data() doc string"},
+	{"m_previous_data", MG_FASTCALL(ex_m_previous_data), MG_METH_FASTCALL, "m_previous_data() doc string"},
+	{"ma_previous", ex_ma_previous, METH_VARARGS, "ma_previous() doc string"},
 
    /* v2.3.46 */
-	{"m_increment", ex_m_increment, METH_VARARGS, "m_increment() doc string"},
+	{"m_increment", MG_FASTCALL(ex_m_increment), MG_METH_FASTCALL, "m_increment() doc string"},
+	{"m_batch", ex_m_batch, METH_VARARGS, "m_batch() doc string"},
+	{"m_request", ex_m_request, METH_VARARGS, "m_request() doc string"},
+	{"m_response_size", ex_m_response_size, METH_VARARGS, "m_response_size() doc string"},
+	{"m_response", ex_m_response, METH_VARARGS, "m_response() doc string"},
+	{"m_iterate", (PyCFunction) (void (*) (void)) ex_m_iterate, METH_VARARGS | METH_KEYWORDS, "m_iterate() doc string"},
+	{"m_query", (PyCFunction) (void (*) (void)) ex_m_query, METH_VARARGS | METH_KEYWORDS, "m_query() doc string"},
+	{"m_global", MG_FASTCALL(ex_m_global), MG_METH_FASTCALL, "m_global() doc string"},
 	{"m_tstart", ex_m_tstart, METH_VARARGS, "m_tstart() doc string"},
 	{"m_tlevel", ex_m_tlevel, METH_VARARGS, "m_tlevel() doc string"},
 	{"m_tcommit", ex_m_tcommit, METH_VARARGS, "m_tcommit() doc string"},
@@ -3978,12 +5929,12 @@ static PyMethodDef mg_python_methods[] = {
 	{"ma_merge_to_db", ex_ma_merge_to_db, METH_VARARGS, "ma_merge_to_db() doc string"},
 	{"ma_merge_from_db", ex_ma_merge_from_db, METH_VARARGS, "ma_merge_from_db() doc string"},
 
-	{"m_proc", ex_m_function, METH_VARARGS, "m_proc() doc string"},
+	{"m_proc", MG_FASTCALL(ex_m_function), MG_METH_FASTCALL, "m_proc() doc string"},
 	{"ma_proc", ex_ma_function, METH_VARARGS, "ma_proc() doc string"},
-	{"m_function", ex_m_function, METH_VARARGS, "m_function() doc string"},
+	{"m_function", MG_FASTCALL(ex_m_function), MG_METH_FASTCALL, "m_function() doc string"},
 	{"ma_function", ex_ma_function, METH_VARARGS, "ma_function() doc string"},
 
-	{"m_classmethod", ex_m_classmethod, METH_VARARGS, "m_classmethod() doc string"},
+	{"m_classmethod", MG_FASTCALL(ex_m_classmethod), MG_METH_FASTCALL, "m_classmethod() doc string"},
 	{"ma_classmethod", ex_ma_classmethod, METH_VARARGS, "ma_classmethod() doc string"},
 
 	{"ma_html_ex", ex_ma_html_ex, METH_VARARGS, "ma_html_ex() doc string"},
@@ -4029,6 +5980,19 @@ static PyObject * moduleinit(void)
    if (PyType_Ready(&MClassType) < 0) {
       return NULL;
    }
+   /* v2.4.50 */
+   if (PyType_Ready(&MIterType) < 0) {
+      return NULL;
+   }
+   if (PyType_Ready(&MQueryType) < 0) {
+      return NULL;
+   }
+   if (PyType_Ready(&MGlobalType) < 0) {
+      return NULL;
+   }
+   if (PyType_Ready(&MConnectionType) < 0) {
+      return NULL;
+   }
 
 #if PY_MAJOR_VERSION >= 3
    m = PyModule_Create(&moduledef);
@@ -4047,6 +6011,14 @@ static PyObject * moduleinit(void)
       return NULL;
   }
 
+   /* v2.4.50 */
+   Py_INCREF(&MConnectionType);
+   if (PyModule_AddObject(m, "Connection", (PyObject *) &MConnectionType) < 0) {
+      Py_DECREF(&MConnectionType);
+      Py_DECREF(m);
+      return NULL;
+   }
+
    dbx_init();
 
    return m;
@@ -4087,6 +6059,8 @@ int mg_type(PyObject *item)
       result = MG_T_FLOAT;
    else if (PyList_Check(item))
       result = MG_T_LIST;
+   else if (PyObject_CheckBuffer(item)) /* v2.4.50: bytes, bytearray, memoryview, ... */
+      result = MG_T_BYTES;
    else
       result = MG_T_VAR;
 #else
@@ -4131,270 +6105,1680 @@ int mg_get_integer(PyObject *item)
          result = 0;
    }
 
-   return result;
+   return result;
+}
+
+
+double mg_get_float(PyObject *item)
+{
+   int t;
+   double result;
+   char *ps;
+
+   result = 0;
+   t = mg_type(item);
+
+   if (t == MG_T_INTEGER)
+#if PY_MAJOR_VERSION >= 3
+      result = (double) PyLong_AsLong(item);
+#else
+      result = (double) PyInt_AsLong(item);
+#endif
+   else if (t == MG_T_FLOAT) {
+      result = (double) PyFloat_AsDouble(item);
+   }
+   else {
+      ps = (char *) MG_GET_PYSTRING(item);
+      if (ps)
+         result = (double) strtod(ps, NULL);
+      else
+         result = 0;
+   }
+
+   return result;
+}
+
+
+/* v2.4.50: the text of keys and values that are not held as strings is written to call-scoped scratch space rather than to temporary Python objects */
+char * mg_get_string(PyObject *item, MGSCRATCH *p_scratch, int *size)
+{
+   int t;
+   double y;
+   char * result;
+   char buffer[512];
+#if PY_MAJOR_VERSION >= 3
+   int overflow;
+   long long x;
+   Py_ssize_t len;
+   Py_buffer view;
+   PyObject *item_tmp;
+#else
+   long x;
+#endif
+
+   result = NULL;
+   t = mg_type(item);
+   *size = 0;
+
+   if (t == MG_T_INTEGER) {
+      /* v2.4.50: the full 64 bits (and beyond: M numbers may be wider) rather than truncated to an int */
+#if PY_MAJOR_VERSION >= 3
+      x = PyLong_AsLongLongAndOverflow(item, &overflow);
+      if (overflow) {
+         item_tmp = PyObject_Str(item);
+         if (item_tmp) {
+            result = (char *) PyUnicode_AsUTF8AndSize(item_tmp, &len);
+            if (result) {
+               result = mg_scratch_copy(p_scratch, result, (int) len);
+               *size = (int) len;
+            }
+            Py_DECREF(item_tmp);
+         }
+      }
+      else if (x == -1 && PyErr_Occurred()) {
+         PyErr_Clear();
+      }
+      else {
+         result = mg_get_int_string(x, p_scratch, size);
+      }
+#else
+      x = PyInt_AsLong(item);
+      result = mg_get_int_string((long long) x, p_scratch, size);
+#endif
+   }
+   else if (t == MG_T_FLOAT) {
+      /* v2.4.50: canonical M form, exact to the last bit rather than rounded to 6 decimal places */
+      y = (double) PyFloat_AsDouble(item);
+      *size = mg_canonical_double(y, buffer);
+      result = mg_scratch_copy(p_scratch, buffer, *size);
+   }
+#if PY_MAJOR_VERSION >= 3
+   else if (t == MG_T_BYTES) {
+      /* v2.4.50: binary data is passed through as it is, without copying where possible */
+      /* Only bytes are referenced in place: large values may be sent from the caller's memory with the GIL released (MGIOV), */
+      /* by which time another thread could have resized or released a mutable buffer, so the others are copied */
+      if (PyBytes_Check(item)) {
+         result = PyBytes_AS_STRING(item);
+         *size = (int) PyBytes_GET_SIZE(item);
+      }
+      else if (PyObject_GetBuffer(item, &view, PyBUF_FULL_RO) == 0) {
+         result = mg_scratch_alloc(p_scratch, (int) view.len);
+         if (result && PyBuffer_ToContiguous(result, &view, view.len, 'C') == 0) {
+            *size = (int) view.len;
+         }
+         else {
+            result = NULL;
+         }
+         PyBuffer_Release(&view);
+      }
+      else {
+         PyErr_Clear();
+      }
+   }
+   else {
+      /* v2.4.50: the size is the length of the UTF-8 encoding rather than the number of characters */
+      result = (char *) PyUnicode_AsUTF8AndSize(item, &len);
+      *size = (int) len;
+   }
+#else
+   else {
+      result = (char *) MG_GET_PYSTRING(item);
+      *size = (int) MG_GET_PYSTRINGSIZE(item);
+   }
+#endif
+
+   if (!result) {
+      result = mg_empty_string;
+      *size = 0;
+   }
+
+   return result;
+}
+
+
+/* v2.4.50: the text for small ints is formatted once and kept */
+char * mg_get_int_string(long long x, MGSCRATCH *p_scratch, int *size)
+{
+   char buffer[32];
+
+   if (x >= 0 && x < MG_INT_CACHE) {
+      if (!mg_int_cache_len[x]) {
+         mg_int_cache_len[x] = (unsigned char) sprintf(mg_int_cache[x], "%d", (int) x);
+      }
+      *size = (int) mg_int_cache_len[x];
+      return mg_int_cache[x];
+   }
+
+   *size = sprintf(buffer, "%lld", x);
+   return mg_scratch_copy(p_scratch, buffer, *size);
+}
+
+
+int mg_get_keys(PyObject *keys, MGSTR * ckeys, MGSCRATCH *p_scratch, char *record)
+{
+   int kmax, max, n, len;
+   PyObject *p;
+
+   kmax = (int) PyList_Size(keys);
+
+   p = PyList_GetItem(keys, 0);
+   max = mg_get_integer(p);
+
+   for (n = 1; n <= max; n ++) {
+      p = PyList_GetItem(keys, n);
+
+      ckeys[n].ps = (unsigned char *) mg_get_string(p, p_scratch, &len);
+      ckeys[n].size = len;
+
+   }
+
+   return max;
+}
+
+
+/* v2.4.50: arguments are taken from a plain array: the server handle and global name (context 0) followed by up to MG_MAX_VARGS keys */
+/* v2.4.50: self is the Connection for Connection methods (whose arguments do not include the database handle) */
+int mg_get_vargs(PyObject *self, PyObject *const *args, Py_ssize_t nargs, MGVARGS *pvargs, int context)
+{
+   int n, len, head;
+
+   mg_scratch_init(&(pvargs->scratch));
+
+   head = 0;
+   if (!context) {
+      head = (self && Py_TYPE(self) == &MConnectionType) ? 1 : 2;
+      if (nargs < head) {
+         PyErr_Format(PyExc_TypeError, "function takes at least %d arguments (%d given)", head, (int) nargs);
+         return -1;
+      }
+      pvargs->handle = (head == 1) ? self : args[0];
+      pvargs->p_page = mg_handle_page(pvargs->handle);
+      if (!pvargs->p_page) {
+         return -1;
+      }
+#if PY_MAJOR_VERSION >= 3
+      if (!PyUnicode_Check(args[head - 1])) {
+#else
+      if (!PyString_Check(args[head - 1])) {
+#endif
+         PyErr_Format(PyExc_TypeError, "argument %d must be str, not %.50s", head, Py_TYPE(args[head - 1])->tp_name);
+         return -1;
+      }
+      pvargs->global = (char *) MG_GET_PYSTRING(args[head - 1]);
+      if (!pvargs->global) {
+         return -1;
+      }
+      args += head;
+      nargs -= head;
+   }
+
+   if (nargs > MG_MAX_VARGS) {
+      PyErr_Format(PyExc_TypeError, "function takes at most %d arguments (%d given)", MG_MAX_VARGS + head, (int) nargs + head);
+      return -1;
+   }
+
+   for (n = 0; n < nargs; n ++) {
+      pvargs->pvars[n] = args[n];
+      pvargs->cvars[n].ps = (unsigned char *) mg_get_string(args[n], &(pvargs->scratch), &len);
+      pvargs->cvars[n].size = len;
+   }
+   if (n < MG_MAX_VARGS) {
+      pvargs->pvars[n] = NULL;
+   }
+
+   return n;
+}
+
+
+void mg_scratch_init(MGSCRATCH *p_scratch)
+{
+   p_scratch->used = 0;
+   p_scratch->p_next = NULL;
+   return;
+}
+
+
+/* v2.4.50: space that does not fit the scratch buffer is allocated in a chain of blocks, freed by mg_scratch_release() */
+char * mg_scratch_alloc(MGSCRATCH *p_scratch, int size)
+{
+   MGSCRATCHBLK *p_blk;
+
+   if ((p_scratch->used + size) < MG_SCRATCH_SIZE) {
+      p_scratch->used += size;
+      return (p_scratch->buffer + (p_scratch->used - size));
+   }
+
+   p_blk = (MGSCRATCHBLK *) mg_malloc((int) sizeof(MGSCRATCHBLK) + size, 0);
+   if (!p_blk) {
+      return NULL;
+   }
+   p_blk->p_next = p_scratch->p_next;
+   p_scratch->p_next = p_blk;
+
+   return (char *) (p_blk + 1);
+}
+
+
+char * mg_scratch_copy(MGSCRATCH *p_scratch, char *data, int size)
+{
+   char *result;
+
+   result = mg_scratch_alloc(p_scratch, size);
+   if (result) {
+      memcpy((void *) result, (void *) data, (size_t) size);
+   }
+
+   return result;
+}
+
+
+int mg_scratch_release(MGSCRATCH *p_scratch)
+{
+   MGSCRATCHBLK *p_blk;
+
+   while ((p_blk = p_scratch->p_next)) {
+      p_scratch->p_next = p_blk->p_next;
+      mg_free((void *) p_blk, 0);
+   }
+   p_scratch->used = 0;
+
+   return 0;
+}
+
+
+/* v2.4.50: the list takes over the reference to item (as with PyList_SetItem()), and any gap is filled with empty strings in one step */
+int mg_set_list_item(PyObject * list, int index, PyObject * item)
+{
+   int size, n, len;
+   PyObject *p;
+   PyObject *pad;
+
+   size = (int) PyList_Size(list);
+
+   if (index == size) {
+      PyList_Append(list, item);
+      Py_DECREF(item);
+      return index;
+   }
+
+   if (size < (index + 1)) {
+      len = (index + 1) - size;
+      pad = PyList_New(len);
+      if (!pad) {
+         Py_DECREF(item);
+         return -1;
+      }
+      p = MG_MAKE_PYSTRING("");
+      for (n = 0; n < len; n ++) {
+         Py_INCREF(p);
+         PyList_SET_ITEM(pad, n, p);
+      }
+      Py_DECREF(p);
+      PyList_SetSlice(list, size, size, pad);
+      Py_DECREF(pad);
+   }
+
+   PyList_SetItem(list, index, item);
+
+   return index;
+}
+
+
+int mg_kill_list(PyObject * list)
+{
+   int result, index;
+
+  index = (int) PyList_Size(list);
+
+   result = PyList_SetSlice(list, 0, index, NULL);
+
+   return result;
+}
+
+
+int mg_kill_list_item(PyObject * list, int index)
+{
+   int result;
+
+   result = PyList_SetSlice(list, index, index + 1, NULL);
+
+   return result;
+}
+
+
+MGPAGE * mg_ppage(int phndle)
+{
+   MGPAGE *p_page;
+
+   p_page = NULL;
+
+   if (phndle > 0 && phndle < MG_MAX_PAGE && tp_page[phndle]) {
+      return tp_page[phndle];
+   }
+
+   if (phndle == 0) {
+      p_page = &gpage;
+      if (!tp_page[0]) {
+         mg_ppage_init(p_page);
+         tp_page[0] = p_page;
+      }
+   }
+
+   return p_page;
+}
+
+
+int mg_ppage_init(MGPAGE * p_page)
+{
+   int n;
+
+   memset((void *) &(p_page->srv), 0, sizeof(MGSRV)); /* v2.4.50 */
+   p_page->p_srv = &(p_page->srv);
+   p_page->bytes_mode = 0;
+   p_page->number_mode = 0;
+   p_page->p_srv->mem_error = 0;
+   p_page->p_srv->mode = 0;
+   p_page->p_srv->storage_mode = 0;
+   p_page->p_srv->timeout = NETX_TIMEOUT;
+   strcpy(p_page->p_srv->server, "");
+   strcpy(p_page->p_srv->uci, "");
+
+   strcpy(p_page->p_srv->ip_address, MG_HOST);
+   p_page->p_srv->port = MG_PORT;
+   strcpy(p_page->p_srv->uci, MG_UCI);
+
+   strcpy(p_page->p_srv->username, "");
+   strcpy(p_page->p_srv->password, "");
+
+   for (n = 0; n < MG_MAXCON; n ++) {
+      p_page->p_srv->pcon[n] = NULL;
+   }
+
+   /* v2.4.50 */
+   p_page->p_srv->buf_high_water = MG_BUF_HIGH_WATER;
+   p_page->p_srv->buf_cache_max = MG_BUF_CACHE_DEFAULT;
+   p_page->p_srv->buf_cache_count = 0;
+   mg_init_critical_section((void *) &(p_page->p_srv->buf_cache_lock));
+
+   strcpy(p_page->p_srv->product, MG_PRODUCT);
+   mg_pool_init(p_page->p_srv);
+
+   return 1;
+}
+
+
+/* v2.4.50 */
+int mg_ppage_host(MGPAGE * p_page, char *netname, int port, char *username, char *password)
+{
+   if (strlen(netname) >= sizeof(p_page->p_srv->ip_address)) {
+      return 0;
+   }
+
+   strcpy(p_page->p_srv->ip_address, netname);
+   p_page->p_srv->port = port;
+   if (username) {
+      strcpy(p_page->p_srv->username, username);
+   }
+   if (password) {
+      strcpy(p_page->p_srv->password, password);
+   }
+   p_page->p_srv->mode = 1;
+
+   return 1;
+}
+
+
+/* v2.4.50: release the buffers, health check and connection pool of a page (the page itself is freed by the caller) */
+int mg_ppage_close(MGPAGE * p_page)
+{
+   mg_buf_cache_free(p_page->p_srv, 0);
+   mg_health_stop(p_page->p_srv);
+   mg_pool_close(p_page->p_srv);
+
+   return 1;
+}
+
+
+/* v2.4.50: close a page (again, if it has already been closed) and free it: the caller makes sure that no other thread is using it */
+/*          (a Connection is only freed once no call holds a reference to it; page handles are checked with mg_ppage_busy()) */
+int mg_ppage_free(MGPAGE * p_page)
+{
+   mg_ppage_close(p_page);
+   mg_pool_destroy(p_page->p_srv);
+   mg_delete_critical_section((void *) &(p_page->p_srv->buf_cache_lock));
+   mg_free((void *) p_page, 0);
+
+   return 1;
+}
+
+
+/* v2.4.50: true if another thread is using the page: waiting on the DB Server (GIL released) or holding one of its connections */
+int mg_ppage_busy(MGPAGE * p_page)
+{
+   int n, busy;
+   MGSRV *p_srv;
+
+   p_srv = p_page->p_srv;
+   if (p_srv->in_flight > 0) {
+      return 1;
+   }
+
+   busy = 0;
+   mg_enter_critical_section((void *) &dbx_global_mutex);
+   for (n = 0; n < MG_MAXCON; n ++) {
+      if (p_srv->pcon[n] && p_srv->pcon[n]->in_use) {
+         busy = 1;
+         break;
+      }
+   }
+   mg_leave_critical_section((void *) &dbx_global_mutex);
+
+   return busy;
+}
+
+
+/* v2.4.50: PyArg_ParseTuple() converter ("O&") for a database handle: a Connection or the number of a page (NULL if there is no such page) */
+int mg_get_page(PyObject *handle, void *pp_page)
+{
+   long phndle;
+
+   if (Py_TYPE(handle) == &MConnectionType) {
+      if (((MConnectionObject *) handle)->closed) {
+         MG_ERROR("mg_python: The connection is closed");
+         return 0;
+      }
+      *((MGPAGE **) pp_page) = ((MConnectionObject *) handle)->p_page;
+      return 1;
+   }
+
+#if PY_MAJOR_VERSION >= 3
+   phndle = PyLong_AsLong(handle);
+#else
+   phndle = PyInt_AsLong(handle);
+#endif
+   if (phndle == -1 && PyErr_Occurred()) {
+      return 0;
+   }
+   *((MGPAGE **) pp_page) = mg_ppage((int) phndle);
+
+   return 1;
+}
+
+
+/* v2.4.50: the database handle for functions that take no other arguments: none for Connection methods */
+int mg_parse_handle(PyObject *self, PyObject *args, MGPAGE **pp_page)
+{
+   *pp_page = NULL;
+   if (self && Py_TYPE(self) == &MConnectionType) {
+      if (!PyArg_ParseTuple(args, "")) {
+         return 0;
+      }
+      *pp_page = mg_handle_page(self);
+   }
+   else {
+      if (!PyArg_ParseTuple(args, "O&", mg_get_page, pp_page)) {
+         return 0;
+      }
+      if (!*pp_page) {
+         MG_ERROR("mg_python: Invalid database handle");
+      }
+   }
+
+   return (*pp_page ? 1 : 0);
+}
+
+
+/* v2.4.50: the page for a database handle, raising an exception if there is none (no handle means page 0) */
+MGPAGE * mg_handle_page(PyObject *handle)
+{
+   MGPAGE *p_page;
+
+   if (!handle) {
+      return mg_ppage(0);
+   }
+
+   p_page = NULL;
+   if (!mg_get_page(handle, (void *) &p_page)) {
+      return NULL;
+   }
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+   }
+
+   return p_page;
+}
+
+
+/* v2.4.50: the page for a database handle held by an object, or NULL (no exception is raised) */
+MGPAGE * mg_handle_ppage(PyObject *handle)
+{
+   long phndle;
+
+   if (!handle) {
+      return mg_ppage(0);
+   }
+   if (Py_TYPE(handle) == &MConnectionType) {
+      return ((MConnectionObject *) handle)->p_page;
+   }
+
+#if PY_MAJOR_VERSION >= 3
+   phndle = PyLong_AsLong(handle);
+#else
+   phndle = PyInt_AsLong(handle);
+#endif
+   if (phndle == -1 && PyErr_Occurred()) {
+      PyErr_Clear();
+      return NULL;
+   }
+
+   return mg_ppage((int) phndle);
+}
+
+
+/* v2.4.50 */
+int mg_global_command(MGSRV *p_srv, int chndle, MGBUF *p_buf, char *command, char *global, MGSTR *cvars, int max)
+{
+   if (mg_server_api_global(p_srv)) {
+      mg_invoke_server_api_global(p_srv, 0, command[0], global, cvars, max, p_buf);
+   }
+   else {
+      mg_request_global(p_srv, chndle, p_buf, command, global, cvars, max);
+      if (p_srv->mem_error) {
+         return -1;
+      }
+      mg_db_send(p_srv, chndle, p_buf, 0);
+      mg_db_receive(p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+   }
+   if (p_srv->mem_error) {
+      return -1;
+   }
+   if (p_buf->data_size < MG_RECV_HEAD || mg_get_error(p_srv, (char *) p_buf->p_buffer)) {
+      return 0;
+   }
+
+   return 1;
+}
+
+
+/* v2.4.50: frame a global command as a complete request */
+int mg_request_global(MGSRV *p_srv, int chndle, MGBUF *p_buf, char *command, char *global, MGSTR *cvars, int max)
+{
+   int n;
+
+   mg_request_header(p_srv, p_buf, command, MG_PRODUCT);
+   mg_request_add(p_srv, chndle, p_buf, (unsigned char *) global, (int) strlen((char *) global), 0, MG_TX_DATA);
+   for (n = 0; n < max; n ++) {
+      mg_request_add(p_srv, chndle, p_buf, (unsigned char *) cvars[n].ps, cvars[n].size, 0, MG_TX_DATA);
+   }
+   mg_request_size(p_srv, p_buf);
+
+   return 1;
+}
+
+
+/* v2.4.50: send several requests together and then read the responses in turn, appending each to p_results as <'v' or 'e'><length (4 bytes)><data> */
+int mg_pipeline(MGSRV *p_srv, int chndle, MGBUF *p_requests, int count, MGBUF *p_buf, MGBUF *p_results)
+{
+   int rc, n;
+
+   rc = 1;
+   if (!mg_db_send(p_srv, chndle, p_requests, 0)) {
+      strcpy(p_srv->error_mess, "mg_python: Unable to send the request to the DB Server");
+      p_buf->data_size = 0;
+      rc = 0;
+   }
+
+   for (n = 0; rc == 1 && n < count; n ++) {
+      mg_db_receive_next(p_srv, chndle, p_buf);
+      if (p_srv->mem_error) {
+         rc = -1;
+         break;
+      }
+      rc = mg_pipeline_result(p_srv, p_buf, p_results);
+   }
+
+   /* Responses may be left unread if the pipeline stops early, so the connection must not be reused */
+   if (rc != 1 && p_srv->mode != 2 && p_srv->pcon[chndle]) {
+      p_srv->pcon[chndle]->keep_alive = 0;
+   }
+
+   return rc;
+}
+
+
+/* v2.4.50: append a response to a list of results */
+int mg_pipeline_result(MGSRV *p_srv, MGBUF *p_buf, MGBUF *p_results)
+{
+   int rc;
+   unsigned long len;
+   unsigned char size[4];
+
+   if (p_buf->data_size < MG_RECV_HEAD) {
+      /* The connection failed part way through */
+      if (p_srv->mode != 2 || !p_srv->error_mess[0]) {
+         strcpy(p_srv->error_mess, "mg_python: No response from the DB Server");
+      }
+      p_buf->data_size = 0;
+      return 0;
+   }
+
+   len = p_buf->data_size - MG_RECV_HEAD;
+   size[0] = mg_get_error(p_srv, (char *) p_buf->p_buffer) ? 'e' : 'v';
+   rc = mg_buf_cat(p_results, (char *) size, 1);
+   mg_set_size(size, len);
+   if (rc) {
+      rc = mg_buf_cat(p_results, (char *) size, 4);
+   }
+   if (rc && len) {
+      rc = mg_buf_cat(p_results, (char *) p_buf->p_buffer + MG_RECV_HEAD, len);
+   }
+
+   return (rc ? 1 : -1);
+}
+
+
+/* v2.4.50: get the data for a list of nodes below a global reference using pipelined requests: each node is packed as <number of subscripts> (<length> <subscript>) ... */
+int mg_pipeline_get(MGSRV *p_srv, int chndle, MGBUF *p_buf, char *global, MGSTR *cvars, int max, MGBUF *p_nodes, int count, MGBUF *p_results)
+{
+   int rc, n, i, chunk, nsubs;
+   unsigned long offset;
+   MGSTR subs[MG_MAX_VARGS + 1];
+   MGBUF requests;
+
+   p_results->data_size = 0;
+   for (i = 0; i < max; i ++) {
+      subs[i] = cvars[i];
+   }
+
+   mg_buf_init(&requests, MG_BUFSIZE, MG_BUFSIZE);
+
+   rc = 1;
+   offset = 0;
+   for (n = 0; rc == 1 && n < count; n += chunk) {
+      requests.data_size = 0;
+      for (chunk = 0; (n + chunk) < count && chunk < MG_BATCH_MAX && requests.data_size < MG_BATCH_CHUNK; chunk ++) {
+         nsubs = mg_node_get(p_nodes, &offset, subs + max, MG_MAX_VARGS - max);
+         mg_request_global(p_srv, chndle, p_buf, "G", global, subs, max + nsubs);
+         if (!mg_buf_cat(&requests, (char *) p_buf->p_buffer, p_buf->data_size)) {
+            rc = -1;
+            break;
+         }
+      }
+      if (rc == 1) {
+         rc = mg_pipeline(p_srv, chndle, &requests, chunk, p_buf, p_results);
+      }
+   }
+
+   mg_buf_free(&requests);
+
+   return rc;
+}
+
+
+/* v2.4.50: get the data for a list of nodes (pipelined) and add the (subscripts, data) items to p_items; the root subscripts are included if 'full' is set */
+int mg_pipeline_items(MGSRV *p_srv, int chndle, MGBUF *p_buf, char *global, MGSTR *cvars, int max, MGBUF *p_nodes, int count, MGBUF *p_items, int full)
+{
+   int rc, n, i, nsubs;
+   unsigned long offset, voffset, len;
+   MGSTR subs[MG_MAX_VARGS + 1];
+   MGBUF values;
+
+   mg_buf_init(&values, MG_BUFSIZE, MG_BUFSIZE);
+
+   rc = mg_pipeline_get(p_srv, chndle, p_buf, global, cvars, max, p_nodes, count, &values);
+
+   for (i = 0; i < max; i ++) {
+      subs[i] = cvars[i];
+   }
+   offset = 0;
+   voffset = 0;
+   for (n = 0; rc == 1 && n < count; n ++) {
+      nsubs = mg_node_get(p_nodes, &offset, subs + max, MG_MAX_VARGS - max);
+      len = mg_get_size(values.p_buffer + voffset + 1);
+      if (values.p_buffer[voffset] == 'e') {
+         if (len > 255) {
+            len = 255;
+         }
+         memcpy((void *) p_srv->error_mess, (void *) (values.p_buffer + voffset + 5), (size_t) len);
+         p_srv->error_mess[len] = '\0';
+         p_buf->data_size = 0;
+         rc = 0;
+         break;
+      }
+      if (full) {
+         rc = mg_item_add(p_items, subs, max + nsubs, 1, values.p_buffer + voffset + 5, len);
+      }
+      else {
+         rc = mg_item_add(p_items, subs + max, nsubs, 0, values.p_buffer + voffset + 5, len);
+      }
+      rc = rc ? 1 : -1;
+      voffset += 5 + len;
+   }
+
+   mg_buf_free(&values);
+
+   return rc;
+}
+
+
+/* v2.4.50: add a node to a list of nodes: <number of subscripts> (<length> <subscript>) ... */
+int mg_node_add(MGBUF *p_nodes, MGSTR *subs, int nsubs)
+{
+   int rc, n;
+   unsigned char size[4];
+
+   mg_set_size(size, (unsigned long) nsubs);
+   rc = mg_buf_cat(p_nodes, (char *) size, 4);
+   for (n = 0; rc && n < nsubs; n ++) {
+      mg_set_size(size, (unsigned long) subs[n].size);
+      rc = mg_buf_cat(p_nodes, (char *) size, 4);
+      if (rc && subs[n].size) {
+         rc = mg_buf_cat(p_nodes, (char *) subs[n].ps, subs[n].size);
+      }
+   }
+
+   return rc;
+}
+
+
+/* v2.4.50: read the node at 'offset' in a list of nodes and move past it: subscripts beyond the first 'nmax' are skipped */
+int mg_node_get(MGBUF *p_nodes, unsigned long *offset, MGSTR *subs, int nmax)
+{
+   int n, nsubs, size;
+
+   nsubs = (int) mg_get_size(p_nodes->p_buffer + *offset);
+   *offset += 4;
+   for (n = 0; n < nsubs; n ++) {
+      size = (int) mg_get_size(p_nodes->p_buffer + *offset);
+      if (n < nmax) {
+         subs[n].size = size;
+         subs[n].ps = p_nodes->p_buffer + *offset + 4;
+      }
+      *offset += 4 + size;
+   }
+
+   return (nsubs < nmax ? nsubs : nmax);
+}
+
+
+/* v2.4.50: add a (subscripts, data) item to the items fetched by an iterator: the number of subscripts is only recorded if 'count' is set */
+int mg_item_add(MGBUF *p_items, MGSTR *subs, int nsubs, int count, unsigned char *value, unsigned long len)
+{
+   int rc;
+   unsigned char size[4];
+
+   if (count) {
+      rc = mg_node_add(p_items, subs, nsubs);
+   }
+   else {
+      mg_set_size(size, (unsigned long) subs[0].size);
+      rc = mg_buf_cat(p_items, (char *) size, 4);
+      if (rc && subs[0].size) {
+         rc = mg_buf_cat(p_items, (char *) subs[0].ps, subs[0].size);
+      }
+   }
+   mg_set_size(size, len);
+   if (rc) {
+      rc = mg_buf_cat(p_items, (char *) size, 4);
+   }
+   if (rc && len) {
+      rc = mg_buf_cat(p_items, (char *) value, len);
+   }
+
+   return rc;
+}
+
+
+/* v2.4.50: m_order_data and m_previous_data: the next (or previous) subscript and its data, as a (key, data) tuple */
+PyObject * mg_order_data(PyObject *self, PyObject *const *args, Py_ssize_t nargs, int direction)
+{
+   int rc, max, chndle;
+   unsigned long len;
+   MGBUF mgbuf, *p_buf;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   PyObject *key, *value, *output;
+
+   if ((max = mg_get_vargs(self, args, nargs, &vargs, 0)) == -1)
+      return NULL;
+
+   if (max < 1) {
+      MG_ERROR("mg_python: No subscript specified");
+      return NULL;
+   }
+
+   p_page = vargs.p_page;
+   if (!p_page) {
+      MG_ERROR("mg_python: Invalid database handle");
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
+
+   MG_FTRACE((direction > 0) ? "m_order_data" : "m_previous_data");
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   rc = mg_db_connect(p_page->p_srv, &chndle, 1);
+   if (rc) {
+      rc = mg_global_order_data(p_page->p_srv, chndle, p_buf, direction, vargs.global, vargs.cvars, max);
+      mg_db_disconnect(p_page->p_srv, chndle, 1);
+   }
+   else {
+      p_buf->data_size = 0;
+   }
+   MG_END_ALLOW_THREADS;
+
+   if (rc < 0) {
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      MG_ERROR("Insufficient memory to process response");
+      return NULL;
+   }
+   if (rc == 0) {
+      if (p_buf->data_size > MG_RECV_HEAD) {
+         MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      }
+      else {
+         MG_ERROR(p_page->p_srv->error_mess);
+      }
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
+   }
+
+   len = 0;
+   if (p_buf->data_size >= (MG_RECV_HEAD + 4)) {
+      len = mg_get_size(p_buf->p_buffer + MG_RECV_HEAD);
+      key = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD + 4, (int) len);
+      value = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD + 4 + len, (int) (p_buf->data_size - (MG_RECV_HEAD + 4 + len)));
+   }
+   else {
+      key = MG_MAKE_PYDATAN(p_page, NULL, 0);
+      value = MG_MAKE_PYDATAN(p_page, NULL, 0);
+   }
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+
+   if (!key || !value) {
+      Py_XDECREF(key);
+      Py_XDECREF(value);
+      return NULL;
+   }
+   output = PyTuple_Pack(2, key, value);
+   Py_DECREF(key);
+   Py_DECREF(value);
+
+   return output;
+}
+
+
+/* v2.4.50: the response holds <key length (4 bytes)><key><data>, or nothing at the end of the list */
+int mg_global_order_data(MGSRV *p_srv, int chndle, MGBUF *p_buf, int direction, char *global, MGSTR *cvars, int max)
+{
+   int rc, n;
+   unsigned long len, size;
+   unsigned char *p;
+   MGBUF key;
+   MGSTR keys[MG_MAX_VARGS];
+
+   if (mg_server_api_global(p_srv)) {
+      mg_invoke_server_api_global(p_srv, 0, (char) ((direction > 0) ? 'N' : 'R'), global, cvars, max, p_buf);
+      if (p_srv->mem_error) {
+         return -1;
+      }
+      if (p_buf->data_size < MG_RECV_HEAD || mg_get_error(p_srv, (char *) p_buf->p_buffer)) {
+         return 0;
+      }
+      return 1;
+   }
+
+   /* The network protocol has no combined command so the key and its data are fetched in consecutive exchanges */
+   rc = mg_global_command(p_srv, chndle, p_buf, (direction > 0) ? "O" : "P", global, cvars, max);
+   if (rc != 1) {
+      return rc;
+   }
+   len = p_buf->data_size - MG_RECV_HEAD;
+   if (len == 0) {
+      return 1;
+   }
+
+   mg_buf_init(&key, (int) len + 1, MG_BUFSIZE);
+   if (!mg_buf_cpy(&key, (char *) p_buf->p_buffer + MG_RECV_HEAD, len)) {
+      mg_buf_free(&key);
+      return -1;
+   }
+   for (n = 0; n < max; n ++) {
+      keys[n] = cvars[n];
+   }
+   keys[max - 1].ps = key.p_buffer;
+   keys[max - 1].size = key.data_size;
+
+   rc = mg_global_command(p_srv, chndle, p_buf, "G", global, keys, max);
+   if (rc == 1) {
+      size = p_buf->data_size + 4 + len;
+      if (size >= p_buf->size && !mg_buf_resize(p_buf, size + 1)) {
+         rc = -1;
+      }
+      else {
+         p = p_buf->p_buffer + MG_RECV_HEAD;
+         memmove((void *) (p + 4 + len), (void *) p, (size_t) (p_buf->data_size - MG_RECV_HEAD));
+         mg_set_size(p, len);
+         memcpy((void *) (p + 4), (void *) key.p_buffer, (size_t) len);
+         p_buf->data_size = size;
+         p_buf->p_buffer[size] = '\0';
+      }
+   }
+   mg_buf_free(&key);
+
+   return rc;
+}
+
+
+/* v2.4.50 */
+int mg_iterate_fetch(MIterObject *self, MGSRV *p_srv, MGBUF *p_buf)
+{
+   int rc, n, chndle, exchanges, nodes_count;
+   unsigned long len;
+   double elapsed;
+   MGBUF nodes;
+
+   self->items.data_size = 0;
+   self->item_offset = 0;
+
+   chndle = 0;
+   if (!mg_db_connect(p_srv, &chndle, 1)) {
+      p_buf->data_size = 0;
+      return 0;
+   }
+
+   /* Over the network, the data for the keys found is requested in one pipelined exchange at the end of the batch */
+   /* The keys are still found with one $Order exchange each, since each request depends on the key returned by the last */
+   nodes_count = 0;
+   if (p_srv->mode != 2) {
+      mg_buf_init(&nodes, MG_BUFSIZE, MG_BUFSIZE);
+   }
+
+   rc = 1;
+   exchanges = 0;
+   elapsed = mg_time();
+   for (n = 0; n < self->batch && !self->done; n ++) {
+      if (self->inclusive) {
+         /* The start subscript is only returned if it exists */
+         self->inclusive = 0;
+         rc = mg_global_command(p_srv, chndle, p_buf, "D", self->global, self->cvars, self->max + 1);
+         exchanges ++;
+         if (rc != 1) {
+            break;
+         }
+         if (p_buf->data_size > MG_RECV_HEAD && p_buf->p_buffer[MG_RECV_HEAD] == '0') {
+            continue;
+         }
+      }
+      else {
+         rc = mg_global_command(p_srv, chndle, p_buf, (self->direction > 0) ? "O" : "P", self->global, self->cvars, self->max + 1);
+         exchanges ++;
+         if (rc != 1) {
+            break;
+         }
+         len = p_buf->data_size - MG_RECV_HEAD;
+         if (len == 0) {
+            self->done = 1;
+            break;
+         }
+         if (!mg_buf_cpy(&(self->key), (char *) p_buf->p_buffer + MG_RECV_HEAD, len)) {
+            rc = -1;
+            break;
+         }
+         self->cvars[self->max].ps = self->key.p_buffer;
+         self->cvars[self->max].size = self->key.data_size;
+      }
+
+      if (self->end.data_size && (mg_collate((char *) self->key.p_buffer, (int) self->key.data_size, (char *) self->end.p_buffer, (int) self->end.data_size) * self->direction) > 0) {
+         self->done = 1;
+         break;
+      }
+
+      if (p_srv->mode != 2) {
+         rc = mg_node_add(&nodes, &(self->cvars[self->max]), 1);
+         nodes_count ++;
+      }
+      else {
+         rc = mg_global_command(p_srv, chndle, p_buf, "G", self->global, self->cvars, self->max + 1);
+         exchanges ++;
+         if (rc != 1) {
+            break;
+         }
+         rc = mg_item_add(&(self->items), &(self->cvars[self->max]), 1, 0, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+      }
+      if (!rc) {
+         rc = -1;
+         break;
+      }
+
+      self->count ++;
+      if (self->limit > 0 && self->count >= self->limit) {
+         self->done = 1;
+         break;
+      }
+   }
+
+   if (rc == 1 && nodes_count) {
+      rc = mg_pipeline_items(p_srv, chndle, p_buf, self->global, self->cvars, self->max, &nodes, nodes_count, &(self->items), 0);
+      exchanges ++;
+   }
+   elapsed = mg_time() - elapsed;
+
+   if (p_srv->mode != 2) {
+      mg_buf_free(&nodes);
+   }
+   mg_db_disconnect(p_srv, chndle, 1);
+
+   if (rc != 1) {
+      return rc;
+   }
+
+   if (exchanges > 0) {
+      mg_iterate_batch(&(self->batch), self->batch_max, (n == self->batch), elapsed);
+   }
+
+   return 1;
+}
+
+
+/* v2.4.50: take a copy of the global reference so that batches can be fetched without reference to Python objects */
+int mg_iterate_root(MGBUF *p_data, char **global, MGSTR *cvars, char *root_global, MGSTR *root_cvars, int max)
+{
+   int n, len;
+   unsigned long size;
+
+   size = (unsigned long) strlen(root_global) + 1;
+   for (n = 0; n < max; n ++) {
+      size += root_cvars[n].size + 1;
+   }
+   mg_buf_init(p_data, (int) size, MG_BUFSIZE);
+   if (p_data->size < size) {
+      return 0;
+   }
+
+   len = (int) strlen(root_global);
+   *global = (char *) p_data->p_buffer;
+   memcpy((void *) *global, (void *) root_global, len + 1);
+   p_data->data_size = len + 1;
+   for (n = 0; n < max; n ++) {
+      cvars[n].ps = p_data->p_buffer + p_data->data_size;
+      cvars[n].size = root_cvars[n].size;
+      memcpy((void *) cvars[n].ps, (void *) root_cvars[n].ps, root_cvars[n].size);
+      cvars[n].ps[root_cvars[n].size] = '\0';
+      p_data->data_size += root_cvars[n].size + 1;
+   }
+
+   return 1;
 }
 
 
-double mg_get_float(PyObject *item)
+/* v2.4.50: start a request for a mglobal node from its encoded header, global name and leading subscripts (encoded again if the server's settings have changed) */
+int mg_global_header(MGlobalObject *self, MGSRV *p_srv, MGBUF *p_buf, char command)
 {
-   int t;
-   double result;
-   char *ps;
+   int n;
 
-   result = 0;
-   t = mg_type(item);
+   if (self->p_srv != p_srv || self->timeout != p_srv->timeout || self->no_retry != p_srv->no_retry || self->storage_mode != p_srv->storage_mode || strcmp(self->uci, p_srv->uci) || strcmp(self->server, p_srv->server)) {
+      self->p_srv = NULL;
+      mg_request_header(p_srv, &(self->request), "G", MG_PRODUCT);
+      mg_request_add(p_srv, 0, &(self->request), (unsigned char *) self->global, (int) strlen(self->global), 0, MG_TX_DATA);
+      for (n = 0; n < self->max; n ++) {
+         mg_request_add(p_srv, 0, &(self->request), self->cvars[n].ps, self->cvars[n].size, 0, MG_TX_DATA);
+      }
+      self->header_len = p_srv->header_len;
+      self->p_srv = p_srv;
+      strcpy(self->server, p_srv->server);
+      strcpy(self->uci, p_srv->uci);
+      self->timeout = p_srv->timeout;
+      self->no_retry = p_srv->no_retry;
+      self->storage_mode = p_srv->storage_mode;
+   }
 
-   if (t == MG_T_INTEGER)
-#if PY_MAJOR_VERSION >= 3
-      result = (double) PyLong_AsLong(item);
-#else
-      result = (double) PyInt_AsLong(item);
-#endif
-   else if (t == MG_T_FLOAT) {
-      result = (double) PyFloat_AsDouble(item);
+   if (!mg_buf_cpy(p_buf, (char *) self->request.p_buffer, (int) self->request.data_size) || p_buf->data_size < (unsigned long) self->header_len) {
+      return 0;
    }
-   else {
-      ps = (char *) MG_GET_PYSTRING(item);
-      if (ps)
-         result = (double) strtod(ps, NULL);
-      else
-         result = 0;
+   /* The command is the one character that differs: ...^<command>^<size>\n */
+   p_buf->p_buffer[self->header_len - 8] = (unsigned char) command;
+   p_srv->header_len = self->header_len;
+   if (p_buf->p_iov) {
+      p_buf->p_iov->count = 0;
+      p_buf->p_iov->size = 0;
    }
 
-   return result;
+   return 1;
 }
 
 
-char * mg_get_string(PyObject *item, PyObject **item_tmp, int *size)
+/* v2.4.50: get (G), set (S), kill (K) or $Data (D) for the node below a mglobal node given by key (a subscript or a tuple of subscripts) */
+PyObject * mg_global_node(MGlobalObject *self, char command, PyObject *key, PyObject *value)
 {
-   int t, x;
-   double y;
-   char * result;
-   char buffer[64];
+   int n, max, chndle;
+   PyObject *args[MG_MAX_VARGS + 1];
+   PyObject *const *keys;
+   Py_ssize_t nkeys;
+   MGSTR cvars[MG_MAX_VARGS];
+   MGBUF mgbuf, *p_buf;
+   MGPAGE *p_page;
+   MGVARGS vargs;
+   MGIOV iov;
+   PyObject *output;
 
-   result = NULL;
-   t = mg_type(item);
-   *size = 0;
+   if (PyTuple_Check(key)) {
+      keys = &PyTuple_GET_ITEM(key, 0);
+      nkeys = PyTuple_GET_SIZE(key);
+   }
+   else {
+      keys = &key;
+      nkeys = 1;
+   }
+   if (value) {
+      if (nkeys >= MG_MAX_VARGS) {
+         MG_ERROR("mg_python: Too many subscripts");
+         return NULL;
+      }
+      for (n = 0; n < nkeys; n ++) {
+         args[n] = keys[n];
+      }
+      args[nkeys ++] = value;
+      keys = args;
+   }
+   if ((self->max + nkeys) > MG_MAX_VARGS) {
+      MG_ERROR("mg_python: Too many subscripts");
+      return NULL;
+   }
+   if ((max = mg_get_vargs(NULL, keys, nkeys, &vargs, 1)) == -1)
+      return NULL;
 
-   if (t == MG_T_INTEGER) {
-#if PY_MAJOR_VERSION >= 3
-      x = (int) PyLong_AsLong(item);
-#else
-      x = (int) PyInt_AsLong(item);
-#endif
-      sprintf(buffer, "%d", x);
-      *size = (int) strlen(buffer);
-      *item_tmp = MG_MAKE_PYSTRING(buffer);
-      result = (char *) MG_GET_PYSTRING(*item_tmp);
+   p_page = mg_handle_page(self->handle);
+   if (!p_page) {
+      mg_scratch_release(&vargs.scratch);
+      return NULL;
+   }
+
+   p_buf = &mgbuf;
+   mg_buf_get(p_page->p_srv, p_buf);
 
+   MG_FTRACE("mglobal");
+
+   MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+   n = mg_db_connect(p_page->p_srv, &chndle, 1);
+   MG_END_ALLOW_THREADS;
+   if (!n) {
+      MG_ERROR(p_page->p_srv->error_mess);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
    }
-   else if (t == MG_T_FLOAT) {
-      y = (double) PyFloat_AsDouble(item);
-      sprintf(buffer, "%f", y);
-      *size = (int) strlen(buffer);
-      *item_tmp = MG_MAKE_PYSTRING(buffer);
-      result = (char *) MG_GET_PYSTRING(*item_tmp);
+
+   if (mg_server_api_global(p_page->p_srv)) {
+      for (n = 0; n < self->max; n ++) {
+         cvars[n] = self->cvars[n];
+      }
+      for (n = 0; n < max; n ++) {
+         cvars[self->max + n] = vargs.cvars[n];
+      }
+      mg_invoke_server_api_global(p_page->p_srv, 0, command, self->global, cvars, self->max + max, p_buf);
    }
    else {
-      result = (char *) MG_GET_PYSTRING(item);
-      *size = (int) MG_GET_PYSTRINGSIZE(item);
+      if (command == 'S') {
+         p_buf->p_iov = &iov; /* send large values without copying them */
+      }
+      if (!mg_global_header(self, p_page->p_srv, p_buf, command)) {
+         p_page->p_srv->mem_error = 1;
+      }
+      for (n = 0; n < max; n ++) {
+         mg_request_add(p_page->p_srv, chndle, p_buf, vargs.cvars[n].ps, vargs.cvars[n].size, 0, MG_TX_DATA);
+      }
+
+      MG_MEMCHECK("Insufficient memory to process request", 1);
+
+      MG_BEGIN_ALLOW_THREADS(p_page->p_srv);
+      mg_db_send(p_page->p_srv, chndle, p_buf, 1);
+
+      mg_db_receive(p_page->p_srv, chndle, p_buf, MG_BUFSIZE, command == 'G' ? 2 : 0);
+      MG_END_ALLOW_THREADS;
+
+      if (command == 'G' && mg_receive_pystring(p_page, chndle, p_buf, &output)) {
+         mg_db_disconnect(p_page->p_srv, chndle, 1);
+         mg_scratch_release(&vargs.scratch);
+         mg_buf_release(p_page->p_srv, p_buf);
+         return output;
+      }
    }
 
-   if (!result) {
-      result = mg_empty_string;
-      *size = 0;
+   MG_MEMCHECK("Insufficient memory to process response", 0);
+
+   mg_db_disconnect(p_page->p_srv, chndle, 1);
+
+   if ((n = mg_get_error(p_page->p_srv, (char *) p_buf->p_buffer))) {
+      MG_ERROR(p_buf->p_buffer + MG_RECV_HEAD);
+      mg_scratch_release(&vargs.scratch);
+      mg_buf_release(p_page->p_srv, p_buf);
+      return NULL;
    }
 
-   return result;
+   output = MG_MAKE_PYDATAN(p_page, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+   mg_scratch_release(&vargs.scratch);
+   mg_buf_release(p_page->p_srv, p_buf);
+   return output;
 }
 
 
-int mg_get_keys(PyObject *keys, MGSTR * ckeys, PyObject **keys_tmp, char *record)
+/* v2.4.50: adapt the batch size to the observed round-trip time so that each batch takes roughly MG_ITER_BATCH_TIME */
+int mg_iterate_batch(int *batch, int batch_max, int full, double elapsed)
 {
-   int kmax, max, n, len;
-   PyObject *p;
+   if (!batch_max || !full) {
+      return 0;
+   }
+   if (elapsed < (MG_ITER_BATCH_TIME / 2) && *batch < batch_max) {
+      *batch *= 2;
+   }
+   else if (elapsed > (MG_ITER_BATCH_TIME * 2) && *batch > 1) {
+      *batch /= 2;
+   }
 
-   kmax = (int) PyList_Size(keys);
+   return 1;
+}
 
-   p = PyList_GetItem(keys, 0);
-   max = mg_get_integer(p);
 
-   for (n = 1; n <= max; n ++) {
-      p = PyList_GetItem(keys, n);
+/* v2.4.50 */
+int mg_canonic_number(char *p, int len)
+{
+   int n, dot, digits;
 
-      ckeys[n].ps = (unsigned char *) mg_get_string(p, &keys_tmp[n], &len);
-      ckeys[n].size = len;
+   if (len < 1 || len > 63) {
+      return 0;
+   }
 
+   n = 0;
+   if (p[0] == '-') {
+      n = 1;
+   }
+   if (p[n] == '0') {
+      return (len == 1);
    }
 
-   return max;
+   dot = 0;
+   digits = 0;
+   for (; n < len; n ++) {
+      if (p[n] == '.') {
+         if (dot) {
+            return 0;
+         }
+         dot = 1;
+      }
+      else if (p[n] >= '0' && p[n] <= '9') {
+         digits ++;
+      }
+      else {
+         return 0;
+      }
+   }
+   if (!digits || (dot && (p[len - 1] == '0' || p[len - 1] == '.'))) {
+      return 0;
+   }
+
+   return 1;
 }
 
 
-int mg_get_vargs(PyObject *args, MGVARGS *pvargs, int context)
+/* v2.4.50: compare two subscripts using M collation (canonic numbers first, in numeric order, then strings) */
+int mg_collate(char *a, int alen, char *b, int blen)
 {
-   int n, max, len;
-   char fmt[64];
-
-   if (context) {
-      len = 0;
-      fmt[len ++] = '|';
-      for (n = 0; n < MG_MAX_VARGS; n ++) {
-         pvargs->pvars[n] = NULL;
-         pvargs->cvars[n].ps = NULL;
-         pvargs->cvars[n].size = 0;
-         fmt[len ++] = 'O';
-      }
-      fmt[len] = '\0';
-
-      if (!PyArg_ParseTuple(args, fmt, &(pvargs->pvars[0]), &(pvargs->pvars[1]),
-            &(pvargs->pvars[2]),  &(pvargs->pvars[3]),  &(pvargs->pvars[4]),  &(pvargs->pvars[5]),  &(pvargs->pvars[6]),
-            &(pvargs->pvars[7]),  &(pvargs->pvars[8]),  &(pvargs->pvars[9]),  &(pvargs->pvars[10]), &(pvargs->pvars[11]),
-            &(pvargs->pvars[12]), &(pvargs->pvars[13]), &(pvargs->pvars[14]), &(pvargs->pvars[15]), &(pvargs->pvars[16]),
-            &(pvargs->pvars[17]), &(pvargs->pvars[18]), &(pvargs->pvars[19]), &(pvargs->pvars[20]), &(pvargs->pvars[21]),
-            &(pvargs->pvars[22]), &(pvargs->pvars[23]), &(pvargs->pvars[24]), &(pvargs->pvars[25]), &(pvargs->pvars[26]),
-            &(pvargs->pvars[27]), &(pvargs->pvars[28]), &(pvargs->pvars[29]), &(pvargs->pvars[30]), &(pvargs->pvars[31]))) {
+   int an, bn, result;
+   double ad, bd;
+   char buffer[64];
 
-         return -1;
-      }
-   }
-   else {
-      len = 0;
-      fmt[len ++] = 'i';
-      fmt[len ++] = 's';
-      fmt[len ++] = '|';
-      for (n = 0; n < MG_MAX_VARGS; n ++) {
-         pvargs->pvars[n] = NULL;
-         pvargs->cvars[n].ps = NULL;
-         pvargs->cvars[n].size = 0;
-         fmt[len ++] = 'O';
-      }
-      fmt[len] = '\0';
-
-      if (!PyArg_ParseTuple(args, fmt, &(pvargs->phndle), &(pvargs->global), &(pvargs->pvars[0]), &(pvargs->pvars[1]),
-            &(pvargs->pvars[2]),  &(pvargs->pvars[3]),  &(pvargs->pvars[4]),  &(pvargs->pvars[5]),  &(pvargs->pvars[6]),
-            &(pvargs->pvars[7]),  &(pvargs->pvars[8]),  &(pvargs->pvars[9]),  &(pvargs->pvars[10]), &(pvargs->pvars[11]),
-            &(pvargs->pvars[12]), &(pvargs->pvars[13]), &(pvargs->pvars[14]), &(pvargs->pvars[15]), &(pvargs->pvars[16]),
-            &(pvargs->pvars[17]), &(pvargs->pvars[18]), &(pvargs->pvars[19]), &(pvargs->pvars[20]), &(pvargs->pvars[21]),
-            &(pvargs->pvars[22]), &(pvargs->pvars[23]), &(pvargs->pvars[24]), &(pvargs->pvars[25]), &(pvargs->pvars[26]),
-            &(pvargs->pvars[27]), &(pvargs->pvars[28]), &(pvargs->pvars[29]), &(pvargs->pvars[30]), &(pvargs->pvars[31]))) {
+   an = mg_canonic_number(a, alen);
+   bn = mg_canonic_number(b, blen);
 
-         return -1;
-      }
+   if (an && bn) {
+      memcpy((void *) buffer, (void *) a, alen);
+      buffer[alen] = '\0';
+      ad = strtod(buffer, NULL);
+      memcpy((void *) buffer, (void *) b, blen);
+      buffer[blen] = '\0';
+      bd = strtod(buffer, NULL);
+      return (ad < bd) ? -1 : ((ad > bd) ? 1 : 0);
+   }
+   if (an) {
+      return -1;
+   }
+   if (bn) {
+      return 1;
    }
-   for (n = 0; n < MG_MAX_VARGS && pvargs->pvars[n]; n ++) {
-      pvargs->cvars[n].ps = (unsigned char *) mg_get_string(pvargs->pvars[n], &(pvargs->py_nkey[n]), &len);
-      pvargs->cvars[n].size = len;
 
+   result = memcmp((void *) a, (void *) b, (size_t) ((alen < blen) ? alen : blen));
+   if (result) {
+      return result;
    }
-   max = n;
 
-   return max;
+   return (alen - blen);
 }
 
 
-int mg_set_list_item(PyObject * list, int index, PyObject * item)
+/* v2.4.50 */
+int mg_query_fetch(MQueryObject *self, MGSRV *p_srv, MGBUF *p_buf)
 {
-   int size, n, len;
-   PyObject *p;
-   PyObject *a;
+   int rc, n, chndle, nodes_count;
+   double elapsed;
+   MGBUF nodes;
 
-   /* printf("set at %d\n", index); */
+   self->items.data_size = 0;
+   self->item_offset = 0;
 
-   size = (int) PyList_Size(list);
+   chndle = 0;
+   if (!mg_db_connect(p_srv, &chndle, 1)) {
+      p_buf->data_size = 0;
+      return 0;
+   }
+
+   /* Over the network, the data for the nodes found is requested in one pipelined exchange at the end of the batch */
+   nodes_count = 0;
+   if (p_srv->mode != 2) {
+      mg_buf_init(&nodes, MG_BUFSIZE, MG_BUFSIZE);
+   }
 
-   /* printf("set at %d size %d\n", index, size); */
+   rc = 1;
+   elapsed = mg_time();
+   for (n = 0; n < self->batch && !self->done; n ++) {
+      rc = mg_query_next(self, p_srv, chndle, p_buf);
+      if (rc != 1) {
+         break;
+      }
+      if (self->done) {
+         break;
+      }
 
-   if (size < (index + 1)) {
-      len = (index + 1) - size;
-      for (n = 0; n < len; n ++) {
-         p = MG_MAKE_PYSTRING("");
-         PyList_Append(list,  p);
+      if (p_srv->mode != 2) {
+         rc = mg_node_add(&nodes, &(self->cvars[self->max]), self->depth);
+         nodes_count ++;
+      }
+      else {
+         rc = mg_global_command(p_srv, chndle, p_buf, "G", self->global, self->cvars, self->max + self->depth);
+         if (rc != 1) {
+            break;
+         }
+         rc = mg_item_add(&(self->items), self->cvars, self->max + self->depth, 1, p_buf->p_buffer + MG_RECV_HEAD, p_buf->data_size - MG_RECV_HEAD);
+      }
+      if (!rc) {
+         rc = -1;
+         break;
+      }
+
+      self->count ++;
+      if (self->limit > 0 && self->count >= self->limit) {
+         self->done = 1;
+         break;
       }
    }
 
-   a = PyList_GetItem(list, index);
-   if (mg_type(a) == MG_T_LIST) {
-      /* DON'T CLOBBER ARRAY */
-      Py_INCREF(a);
+   if (rc == 1 && nodes_count) {
+      rc = mg_pipeline_items(p_srv, chndle, p_buf, self->global, self->cvars, self->max, &nodes, nodes_count, &(self->items), 1);
    }
+   elapsed = mg_time() - elapsed;
 
-   /* printf("set SET at %d\n", index); */
+   if (p_srv->mode != 2) {
+      mg_buf_free(&nodes);
+   }
+   mg_db_disconnect(p_srv, chndle, 1);
 
-   PyList_SetItem(list, index, item);
-   Py_INCREF(list); /* v2.3.46 */
+   if (rc != 1) {
+      return rc;
+   }
 
-   return index;
+   mg_iterate_batch(&(self->batch), self->batch_max, (n == self->batch), elapsed);
+
+   return 1;
 }
 
 
-int mg_kill_list(PyObject * list)
+/* v2.4.50: move to the next (or previous) node that holds data, setting 'done' at the end of the tree */
+int mg_query_next(MQueryObject *self, MGSRV *p_srv, int chndle, MGBUF *p_buf)
 {
-   int result, index;
+   int rc, n, descend, data;
+   unsigned long len, offset;
+   char *command;
+   unsigned char *p;
+
+   if (self->native) {
+      self->started = 1;
+      rc = mg_global_command(p_srv, chndle, p_buf, "Q", self->global, self->cvars, self->max + self->depth);
+      if (rc != 1) {
+         return rc;
+      }
+      /* The next node is returned as a list of subscripts: check that it still lies below the root */
+      p = p_buf->p_buffer + MG_RECV_HEAD;
+      len = p_buf->data_size - MG_RECV_HEAD;
+      offset = 0;
+      for (n = 0; offset < len; n ++) {
+         data = (int) mg_get_size(p + offset);
+         offset += 4;
+         if (n < self->max) {
+            if (data != (int) self->cvars[n].size || (data && memcmp((void *) (p + offset), (void *) self->cvars[n].ps, (size_t) data))) {
+               break;
+            }
+         }
+         else {
+            if ((n + 1) > MG_MAX_VARGS) {
+               strcpy(p_srv->error_mess, "mg_python: Too many subscripts");
+               p_buf->data_size = 0;
+               return 0;
+            }
+            if (!mg_query_set(self, n - self->max, (char *) p + offset, (unsigned long) data)) {
+               return -1;
+            }
+         }
+         offset += data;
+      }
+      if (offset < len || n <= self->max) {
+         self->done = 1;
+      }
+      return 1;
+   }
 
-  index = (int) PyList_Size(list);
+   command = (self->direction > 0) ? "O" : "P";
 
-   result = PyList_SetSlice(list, 0, index, NULL);
+   if (!self->started) {
+      self->started = 1;
+      rc = mg_global_command(p_srv, chndle, p_buf, "D", self->global, self->cvars, self->max);
+      if (rc != 1) {
+         return rc;
+      }
+      self->last_data = (int) strtol((char *) p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+      descend = (self->last_data >= 10);
+   }
+   else {
+      /* Going forward, a node is followed by its descendants; going backward, they have already been visited */
+      descend = (self->direction > 0 && self->last_data >= 10);
+   }
 
-   return result;
+   while (1) {
+      if (descend) {
+         if ((self->max + self->depth) >= MG_MAX_VARGS) {
+            strcpy(p_srv->error_mess, "mg_python: Too many subscripts");
+            p_buf->data_size = 0;
+            return 0;
+         }
+         if (!mg_query_set(self, self->depth, NULL, 0)) {
+            return -1;
+         }
+      }
+      else if (self->depth == 0) {
+         self->done = 1;
+         return 1;
+      }
+
+      rc = mg_global_command(p_srv, chndle, p_buf, command, self->global, self->cvars, self->max + self->depth);
+      if (rc != 1) {
+         return rc;
+      }
+      len = p_buf->data_size - MG_RECV_HEAD;
+
+      if (len > 0) {
+         if (!mg_query_set(self, self->depth - 1, (char *) p_buf->p_buffer + MG_RECV_HEAD, len)) {
+            return -1;
+         }
+         rc = mg_global_command(p_srv, chndle, p_buf, "D", self->global, self->cvars, self->max + self->depth);
+         if (rc != 1) {
+            return rc;
+         }
+         data = (int) strtol((char *) p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+         self->last_data = data;
+         if (self->direction > 0) {
+            if (data == 1 || data == 11) {
+               return 1;
+            }
+            descend = (data >= 10);
+         }
+         else {
+            if (data < 10) {
+               return 1;
+            }
+            descend = 1;
+         }
+      }
+      else {
+         /* No more subscripts at this level: return to the parent */
+         self->depth --;
+         self->path.data_size = self->path_offset[self->depth];
+         descend = 0;
+         if (self->direction < 0 && self->depth > 0) {
+            rc = mg_global_command(p_srv, chndle, p_buf, "D", self->global, self->cvars, self->max + self->depth);
+            if (rc != 1) {
+               return rc;
+            }
+            data = (int) strtol((char *) p_buf->p_buffer + MG_RECV_HEAD, NULL, 10);
+            self->last_data = data;
+            if (data == 1 || data == 11) {
+               return 1;
+            }
+         }
+      }
+   }
+
+   return 1;
 }
 
 
-int mg_kill_list_item(PyObject * list, int index)
+/* v2.4.50: set the subscript at the level specified (below the root) and discard any lower levels */
+int mg_query_set(MQueryObject *self, int level, char *sub, unsigned long len)
 {
-   int result;
+   int n;
 
-   result = PyList_SetSlice(list, index, index + 1, NULL);
+   self->path.data_size = self->path_offset[level];
+   if (len > 0 && !mg_buf_cat(&(self->path), sub, len)) {
+      return 0;
+   }
+   self->depth = level + 1;
+   self->path_offset[self->depth] = self->path.data_size;
 
-   return result;
+   /* The path buffer may have moved */
+   for (n = 0; n < self->depth; n ++) {
+      self->cvars[self->max + n].ps = self->path.p_buffer + self->path_offset[n];
+      self->cvars[self->max + n].size = (int) (self->path_offset[n + 1] - self->path_offset[n]);
+   }
+
+   return 1;
 }
 
 
-MGPAGE * mg_ppage(int phndle)
+/* v2.4.50 */
+int mg_batch_command(char *op)
 {
-   MGPAGE *p_page;
-
-   p_page = NULL;
+   int n;
+   static char *ops[] = {"set", "get", "kill", "data", "order", "previous", "increment", NULL};
 
-   if (phndle > 0 && phndle < MG_MAX_PAGE && tp_page[phndle]) {
-      return tp_page[phndle];
+   if (op[0] && !op[1]) {
+      if (strchr("SGKDOPI", op[0])) {
+         return (int) op[0];
+      }
+      return 0;
    }
-
-   if (phndle == 0) {
-      p_page = &gpage;
-      if (!tp_page[0]) {
-         mg_ppage_init(p_page);
-         tp_page[0] = p_page;
+   for (n = 0; ops[n]; n ++) {
+      if (!strcmp(op, ops[n])) {
+         return (n == 1) ? 'G' : (n == 5) ? 'P' : (int) toupper((int) op[0]);
       }
    }
 
-   return p_page;
+   return 0;
 }
 
 
-int mg_ppage_init(MGPAGE * p_page)
+/* v2.4.50: execute a batch of global commands, sending them to the DB Server together (network) or in turn (API) */
+int mg_batch_execute(MGSRV *p_srv, MGBUF *p_ops, int count, MGBUF *p_buf, MGBUF *p_results)
 {
-   int n;
+   int rc, n, i, chunk, chndle, max, direct;
+   unsigned long offset, len;
+   unsigned char *p;
+   char command[2];
+   char *global;
+   MGSTR cvars[MG_MAX_VARGS + 1];
+   MGBUF requests;
 
-   p_page->p_srv = &(p_page->srv);
-   p_page->p_srv->mem_error = 0;
-   p_page->p_srv->mode = 0;
-   p_page->p_srv->storage_mode = 0;
-   p_page->p_srv->timeout = NETX_TIMEOUT;
-   strcpy(p_page->p_srv->server, "");
-   strcpy(p_page->p_srv->uci, "");
+   p_results->data_size = 0;
 
-   strcpy(p_page->p_srv->ip_address, MG_HOST);
-   p_page->p_srv->port = MG_PORT;
-   strcpy(p_page->p_srv->uci, MG_UCI);
+   chndle = 0;
+   if (!mg_db_connect(p_srv, &chndle, 1)) {
+      p_buf->data_size = 0;
+      return 0;
+   }
+   direct = mg_server_api_global(p_srv);
+
+   mg_buf_init(&requests, MG_BUFSIZE, MG_BUFSIZE);
+
+   rc = 1;
+   command[1] = '\0';
+   offset = 0;
+   for (n = 0; rc == 1 && n < count; n += chunk) {
+      requests.data_size = 0;
+      for (chunk = 0; (n + chunk) < count && chunk < MG_BATCH_MAX && requests.data_size < MG_BATCH_CHUNK; ) {
+         /* Unpack the next operation */
+         p = p_ops->p_buffer + offset;
+         command[0] = (char) p[0];
+         max = (int) mg_get_size(p + 1) - 1;
+         offset += 5;
+         len = mg_get_size(p_ops->p_buffer + offset);
+         global = (char *) p_ops->p_buffer + offset + 4;
+         offset += 4 + len + 1;
+         for (i = 0; i < max; i ++) {
+            cvars[i].size = (int) mg_get_size(p_ops->p_buffer + offset);
+            cvars[i].ps = p_ops->p_buffer + offset + 4;
+            offset += 4 + cvars[i].size;
+         }
+         chunk ++;
 
-   strcpy(p_page->p_srv->username, "");
-   strcpy(p_page->p_srv->password, "");
+         if (p_srv->mode == 2) {
+            /* API mode: one command at a time */
+            if (direct) {
+               mg_invoke_server_api_global(p_srv, 0, command[0], global, cvars, max, p_buf);
+            }
+            else {
+               mg_request_global(p_srv, chndle, p_buf, command, global, cvars, max);
+               mg_db_send(p_srv, chndle, p_buf, 0);
+               mg_db_receive(p_srv, chndle, p_buf, MG_BUFSIZE, 0);
+            }
+            rc = p_srv->mem_error ? -1 : mg_pipeline_result(p_srv, p_buf, p_results);
+            break;
+         }
 
-   for (n = 0; n < MG_MAXCON; n ++) {
-      p_page->p_srv->pcon[n] = NULL;
+         mg_request_global(p_srv, chndle, p_buf, command, global, cvars, max);
+         if (!mg_buf_cat(&requests, (char *) p_buf->p_buffer, p_buf->data_size)) {
+            rc = -1;
+            break;
+         }
+      }
+      if (rc == 1 && p_srv->mode != 2) {
+         rc = mg_pipeline(p_srv, chndle, &requests, chunk, p_buf, p_results);
+      }
    }
 
-   return 1;
-}
+   mg_buf_free(&requests);
+   mg_db_disconnect(p_srv, chndle, 1);
 
+   return rc;
+}